@@ -25,6 +25,11 @@
  */
 
 #include "XInput.h"
+#include "XInputRecorder.h"
+#include "XInputDirectInput.h"
+#include "XInputTelemetry.h"
+#include "XInputProfile.h"
+#include "XInputCalibration.h"
 
  // AVR Board with USB support
 #if defined(USBCON)
@@ -56,18 +61,17 @@
 
 // --------------------------------------------------------
 // XInput Button Maps                                     |
-// (Matches ID to tx index with bitmask)                  |
+// (Matches ID to button state bit, by tx index)          |
 // --------------------------------------------------------
 
 struct XInputMap_Button {
 	constexpr XInputMap_Button(uint8_t i, uint8_t o)
-		: index(i), mask(BuildMask(o)) {}
-	const uint8_t index;
-	const uint8_t mask;
+		: mask(BuildMask(i, o)) {}
+	const uint16_t mask;
 
 private:
-	constexpr static uint8_t BuildMask(uint8_t offset) {
-		return (1 << offset);  // Bitmask of bit to flip
+	constexpr static uint16_t BuildMask(uint8_t index, uint8_t offset) {
+		return (1 << ((index - 2) * 8 + offset));  // Button word starts at tx[2]
 	}
 };
 
@@ -75,6 +79,7 @@ static const XInputMap_Button Map_DpadUp(2, 0);
 static const XInputMap_Button Map_DpadDown(2, 1);
 static const XInputMap_Button Map_DpadLeft(2, 2);
 static const XInputMap_Button Map_DpadRight(2, 3);
+static const uint16_t Map_DpadMask = Map_DpadUp.mask | Map_DpadDown.mask | Map_DpadLeft.mask | Map_DpadRight.mask;
 static const XInputMap_Button Map_ButtonStart(2, 4);
 static const XInputMap_Button Map_ButtonBack(2, 5);
 static const XInputMap_Button Map_ButtonL3(2, 6);
@@ -113,20 +118,22 @@ const XInputMap_Button * getButtonFromEnum(XInputControl ctrl) {
 
 // --------------------------------------------------------
 // XInput Trigger Maps                                    |
-// (Matches ID to tx index)                               |
+// (Matches ID to trigger state index)                    |
 // --------------------------------------------------------
 
 struct XInputMap_Trigger {
 	constexpr XInputMap_Trigger(uint8_t i)
 		: index(i) {}
 	static const XInputController::Range range;
+	static const XInputController::Range fine;
 	const uint8_t index;
 };
 
-const XInputController::Range XInputMap_Trigger::range = { 0, 255 };  // uint8_t
+const XInputController::Range XInputMap_Trigger::range = { 0, 255 };  // uint8_t, as reported
+const XInputController::Range XInputMap_Trigger::fine = { 0, 65535 };  // uint16_t, as stored
 
-static const XInputMap_Trigger Map_TriggerLeft(4);
-static const XInputMap_Trigger Map_TriggerRight(5);
+static const XInputMap_Trigger Map_TriggerLeft(0);
+static const XInputMap_Trigger Map_TriggerRight(1);
 
 const XInputMap_Trigger * getTriggerFromEnum(XInputControl ctrl) {
 	switch (ctrl) {
@@ -138,23 +145,21 @@ const XInputMap_Trigger * getTriggerFromEnum(XInputControl ctrl) {
 
 // --------------------------------------------------------
 // XInput Joystick Maps                                   |
-// (Matches ID to tx x/y high/low indices)                |
+// (Matches ID to joystick state x/y indices)             |
 // --------------------------------------------------------
 
 struct XInputMap_Joystick {
-	constexpr XInputMap_Joystick(uint8_t xl, uint8_t xh, uint8_t yl, uint8_t yh)
-		: x_low(xl), x_high(xh), y_low(yl), y_high(yh) {}
+	constexpr XInputMap_Joystick(uint8_t xi, uint8_t yi)
+		: x(xi), y(yi) {}
 	static const XInputController::Range range;
-	const uint8_t x_low;
-	const uint8_t x_high;
-	const uint8_t y_low;
-	const uint8_t y_high;
+	const uint8_t x;
+	const uint8_t y;
 };
 
 const XInputController::Range XInputMap_Joystick::range = { -32768, 32767 };  // int16_t
 
-static const XInputMap_Joystick Map_JoystickLeft(6, 7, 8, 9);
-static const XInputMap_Joystick Map_JoystickRight(10, 11, 12, 13);
+static const XInputMap_Joystick Map_JoystickLeft(0, 1);
+static const XInputMap_Joystick Map_JoystickRight(2, 3);
 
 const XInputMap_Joystick * getJoyFromEnum(XInputControl ctrl) {
 	switch (ctrl) {
@@ -179,27 +184,166 @@ struct XInputMap_Rumble {
 static const XInputMap_Rumble RumbleLeft(3, 0);   // Large motor
 static const XInputMap_Rumble RumbleRight(4, 1);  // Small motor
 
+// --------------------------------------------------------
+// XInput SOCD Press Order                                |
+// (Per-axis held states and most recent press)          |
+// --------------------------------------------------------
+
+static const uint8_t SOCD_HeldA    = 0x01;
+static const uint8_t SOCD_HeldB    = 0x02;
+static const uint8_t SOCD_LastA    = 0x04;
+static const uint8_t SOCD_LastB    = 0x08;
+static const uint8_t SOCD_LastMask = SOCD_LastA | SOCD_LastB;
+
+static void resolveSOCDAxis(uint8_t & state, XInputSOCD mode, boolean resolve, boolean aPriority, boolean & a, boolean & b) {
+	// Track press order, even if not resolving, so a policy change takes effect cleanly
+	const boolean pressedA = a && !(state & SOCD_HeldA);
+	const boolean pressedB = b && !(state & SOCD_HeldB);
+
+	uint8_t last = state & SOCD_LastMask;
+	if (pressedA && pressedB) last = 0;  // Same-frame press, no order
+	else if (pressedA) last = SOCD_LastA;
+	else if (pressedB) last = SOCD_LastB;
+
+	state = (a ? SOCD_HeldA : 0) | (b ? SOCD_HeldB : 0) | last;
+
+	if (!resolve || !(a && b)) return;  // No conflict to resolve
+
+	switch (mode) {
+	case(XInputSOCD::UpPriority):
+		if (aPriority) { b = false; }
+		else { a = false; b = false; }
+		break;
+	case(XInputSOCD::LastInput):
+		a = (last == SOCD_LastA);
+		b = (last == SOCD_LastB);
+		break;
+	case(XInputSOCD::FirstInput):
+		a = (last == SOCD_LastB);
+		b = (last == SOCD_LastA);
+		break;
+	case(XInputSOCD::Neutral):
+	default:
+		a = false;
+		b = false;
+		break;
+	}
+}
+
+// --------------------------------------------------------
+// XInput Response Shaping                                |
+// (Curve math is in XInputShapeTable, XInput.h)          |
+// --------------------------------------------------------
+
+// Integer estimate of sqrt(x^2 + y^2), within ~3% of the true magnitude
+static uint32_t estimateMagnitude(int32_t x, int32_t y) {
+	const uint32_t ax = x < 0 ? -x : x;
+	const uint32_t ay = y < 0 ? -y : y;
+	const uint32_t hi = ax > ay ? ax : ay;
+	const uint32_t lo = ax > ay ? ay : ax;
+	const uint32_t est = hi - (hi >> 3) + (lo >> 1);
+	return est > hi ? est : hi;
+}
+
+// --------------------------------------------------------
+// XInput Interrupt Guard                                 |
+// (Stores the frame interrupt reads, from any context)   |
+// --------------------------------------------------------
+
+// Saves the interrupt mask and holds interrupts off. Restoring puts the
+// mask back as it was, so a guarded store inside flush() or an interrupt
+// doesn't turn interrupts back on early.
+static inline uint32_t XInputLib_IRQSave() {
+#if defined(__arm__)
+	uint32_t primask;
+	__asm__ volatile("mrs %0, primask" : "=r" (primask) :: "memory");
+	__disable_irq();
+	return primask;
+#elif defined(SREG)
+	const uint8_t sreg = SREG;
+	cli();
+	return sreg;
+#else
+	return 0;  // Host build, no interrupts
+#endif
+}
+
+static inline void XInputLib_IRQRestore(uint32_t state) {
+#if defined(__arm__)
+	if (state == 0) __enable_irq();  // Were on
+#elif defined(SREG)
+	SREG = (uint8_t) state;
+#else
+	(void) state;
+#endif
+}
+
 // --------------------------------------------------------
 // XInput USB Receive Callback                            |
 // --------------------------------------------------------
 
+// Controllers by USB interface index. One callback serves every interface,
+// so each registered controller polls its own RX endpoint.
+static XInputController * XInputLib_Instances[XInputController::MaxControllers];
+
 #if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
 static void XInputLib_Receive_Callback() {
-	XInput.receive();
+	for (uint8_t i = 0; i < XInputController::MaxControllers; i++) {
+		if (XInputLib_Instances[i] != nullptr) {
+			XInputLib_Instances[i]->receive();
+		}
+	}
 }
 #endif
 
+// --------------------------------------------------------
+// XInput USB State Callback                              |
+// --------------------------------------------------------
+
+static XInputController::StateCallbackType XInputLib_StateCallback = nullptr;
+
+// From the USB interrupt. Leaving 'configured' means the host is gone
+// (reset, unconfigured) or asleep, so nothing queued will be wanted.
+void XInputLib_State_Callback(uint8_t state, uint8_t previous) {
+	const uint8_t configured = (uint8_t) XInputUSBState::Configured;
+	if (previous == configured && state != configured) {
+		const boolean reset = (state != (uint8_t) XInputUSBState::Suspended);
+		for (uint8_t i = 0; i < XInputController::MaxControllers; i++) {
+			if (XInputLib_Instances[i] != nullptr) {
+				XInputLib_Instances[i]->hostLost(reset);
+			}
+		}
+	}
+
+	if (XInputLib_StateCallback != nullptr) {
+		XInputLib_StateCallback((XInputUSBState) state, (XInputUSBState) previous);
+	}
+}
+
 
 // --------------------------------------------------------
 // XInputController Class (API)                           |
 // --------------------------------------------------------
 
-XInputController::XInputController() :
-	tx(), rumble() // Zero initialize arrays
+XInputController::XInputController(uint8_t index) :
+	ditherOption(false), ditherError(),
+	tx(), // Zero initialize arrays
+	autoSendOption(false),  // Set by reset(), after the controls are cleared without sending
+	overlay(nullptr), frameSync(false), sendHeld(false), resend(false),
+	sendCallback(nullptr), remapPress(0), remapRelease(0),
+	rumble(),
+	recorder(nullptr), mirror(nullptr),
+	usbIndex(index),
+	calibration(nullptr),
+	profile(nullptr)
 {
 	reset();
+	if (index < MaxControllers) {
+		XInputLib_Instances[index] = this;
+	}
 #if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
 	XInputUSB::setRecvCallback(XInputLib_Receive_Callback);
+	XInputUSB::setStateCallback(XInputLib_State_Callback);
 #endif
 }
 
@@ -220,9 +364,11 @@ void XInputController::setButton(uint8_t button, boolean state) {
 	if (buttonData != nullptr) {
 		if (getButton(button) == state) return;  // Button hasn't changed
 
-		if (state) { tx[buttonData->index] |= buttonData->mask; }  // Press
-		else { tx[buttonData->index] &= ~(buttonData->mask); }  // Release
-		newData = true;
+		if (state) { controls.buttons |= buttonData->mask; }  // Press
+		else { controls.buttons &= ~(buttonData->mask); }  // Release
+		if (buttonData->mask & Map_DpadMask) {
+			dpadHeld = controls.buttons & Map_DpadMask;  // Set directly, no cleaning
+		}
 		autosend();
 	}
 	else {
@@ -232,26 +378,58 @@ void XInputController::setButton(uint8_t button, boolean state) {
 	}
 }
 
+void XInputController::setButtons(uint16_t buttons, uint16_t mask) {
+	uint16_t next = (controls.buttons & ~mask) | (buttons & mask);
+
+	if (mask & Map_DpadMask) {
+		// Clean from the raw d-pad, as the unmasked directions in the
+		// control state may have been cleaned away already
+		const uint8_t raw = (dpadHeld & ~mask) | (buttons & mask & Map_DpadMask);
+		dpadHeld = raw;
+
+		boolean up    = raw & Map_DpadUp.mask;
+		boolean down  = raw & Map_DpadDown.mask;
+		boolean left  = raw & Map_DpadLeft.mask;
+		boolean right = raw & Map_DpadRight.mask;
+		cleanSOCD(socdDpad, true, up, down, left, right);
+
+		next &= ~Map_DpadMask;
+		if (up)    next |= Map_DpadUp.mask;
+		if (down)  next |= Map_DpadDown.mask;
+		if (left)  next |= Map_DpadLeft.mask;
+		if (right) next |= Map_DpadRight.mask;
+	}
+
+	if (next == controls.buttons) return;  // Buttons haven't changed
+	controls.buttons = next;
+	autosend();
+}
+
+uint16_t XInputController::getButtonMask(uint8_t button) {
+	const XInputMap_Button * buttonData = getButtonFromEnum((XInputControl) button);
+	if (buttonData == nullptr) return 0;  // Not a button
+	return buttonData->mask;
+}
+
 void XInputController::setDpad(XInputControl pad, boolean state) {
 	setButton(pad, state);
 }
 
 void XInputController::setDpad(boolean up, boolean down, boolean left, boolean right, boolean useSOCD) {
-	// Simultaneous Opposite Cardinal Directions (SOCD) Cleaner
-	if (useSOCD) {
-		if (up && down) { down = false; }  // Up + Down = Up
-		if (left && right) { left = false; right = false; }  // Left + Right = Neutral
-	}
+	const uint8_t raw = (up ? Map_DpadUp.mask : 0) | (down ? Map_DpadDown.mask : 0)
+		| (left ? Map_DpadLeft.mask : 0) | (right ? Map_DpadRight.mask : 0);
+	cleanSOCD(socdDpad, useSOCD, up, down, left, right);
+
+	// One store for the whole d-pad, so a frame-synced report never
+	// packs it part way through
+	uint16_t next = controls.buttons & ~Map_DpadMask;
+	if (up)    next |= Map_DpadUp.mask;
+	if (down)  next |= Map_DpadDown.mask;
+	if (left)  next |= Map_DpadLeft.mask;
+	if (right) next |= Map_DpadRight.mask;
+	controls.buttons = next;
+	dpadHeld = raw;  // Uncleaned, for setButtons()
 
-	const boolean autoSendTemp = autoSendOption;  // Save autosend state
-	autoSendOption = false;  // Disable temporarily
-
-	setDpad(DPAD_UP, up);
-	setDpad(DPAD_DOWN, down);
-	setDpad(DPAD_LEFT, left);
-	setDpad(DPAD_RIGHT, right);
-
-	autoSendOption = autoSendTemp;  // Re-enable from option
 	autosend();
 }
 
@@ -259,11 +437,20 @@ void XInputController::setTrigger(XInputControl trigger, int32_t val) {
 	const XInputMap_Trigger * triggerData = getTriggerFromEnum(trigger);
 	if (triggerData == nullptr) return;  // Not a trigger
 
-	val = rescaleInput(val, *getRangeFromEnum(trigger), XInputMap_Trigger::range);
-	if (getTrigger(trigger) == val) return;  // Trigger hasn't changed
+	XInputCalibration * const cal = calibration;
+	const uint8_t axis = (trigger == TRIGGER_LEFT) ? XInputCalibration::TriggerLeft : XInputCalibration::TriggerRight;
+	if (cal == nullptr || !cal->transform(axis, val)) {
+		val = rescaleInput(val, *getRangeFromEnum(trigger), XInputMap_Trigger::fine);
+	}
+
+	const XInputProfile * const p = profile;
+	if (p != nullptr && (p->invert & (trigger == TRIGGER_LEFT ? XInputProfile::InvertTriggerLeft : XInputProfile::InvertTriggerRight))) {
+		val = invertAxis(val, XInputMap_Trigger::fine);
+	}
+	val = shapeTrigger(getShapeTable(trigger), val);
+	if (controls.triggers[triggerData->index] == val) return;  // Trigger hasn't changed
 
-	tx[triggerData->index] = val;
-	newData = true;
+	controls.triggers[triggerData->index] = val;
 	autosend();
 }
 
@@ -271,8 +458,22 @@ void XInputController::setJoystick(XInputControl joy, int32_t x, int32_t y) {
 	const XInputMap_Joystick * joyData = getJoyFromEnum(joy);
 	if (joyData == nullptr) return;  // Not a joystick
 
-	x = rescaleInput(x, *getRangeFromEnum(joy), XInputMap_Joystick::range);
-	y = rescaleInput(y, *getRangeFromEnum(joy), XInputMap_Joystick::range);
+	XInputCalibration * const cal = calibration;
+	const uint8_t axisX = (joy == JOY_LEFT) ? XInputCalibration::LeftX : XInputCalibration::RightX;
+	if (cal == nullptr || !cal->transform(axisX, x)) {
+		x = rescaleInput(x, *getRangeFromEnum(joy), XInputMap_Joystick::range);
+	}
+	if (cal == nullptr || !cal->transform(axisX + 1, y)) {
+		y = rescaleInput(y, *getRangeFromEnum(joy), XInputMap_Joystick::range);
+	}
+
+	const XInputProfile * const p = profile;
+	if (p != nullptr && p->invert != 0) {
+		const uint8_t flags = (joy == JOY_LEFT) ? p->invert : (p->invert >> 2);  // Right stick flags are shifted by 2
+		if (flags & XInputProfile::InvertLeftX) x = invertAxis(x, XInputMap_Joystick::range);
+		if (flags & XInputProfile::InvertLeftY) y = invertAxis(y, XInputMap_Joystick::range);
+	}
+	shapeJoystick(getShapeTable(joy), x, y);
 
 	setJoystickDirect(joy, x, y);
 }
@@ -286,12 +487,8 @@ void XInputController::setJoystick(XInputControl joy, boolean up, boolean down,
 	int16_t x = 0;
 	int16_t y = 0;
 
-	// Simultaneous Opposite Cardinal Directions (SOCD) Cleaner
-	if (useSOCD) {
-		if (up && down) { down = false; }  // Up + Down = Up
-		if (left && right) { left = false; right = false; }  // Left + Right = Neutral
-	}
-	
+	cleanSOCD(*getSOCDFromEnum(joy), useSOCD, up, down, left, right);
+
 	// Analog axis means directions are mutually exclusive. Only change the
 	// output from '0' if the per-axis inputs are different, in order to
 	// avoid the '-1' result from adding the int16 extremes
@@ -309,33 +506,61 @@ void XInputController::setJoystickDirect(XInputControl joy, int16_t x, int16_t y
 	const XInputMap_Joystick * joyData = getJoyFromEnum(joy);
 	if (joyData == nullptr) return;  // Not a joystick
 
-	if (getJoystickX(joy) == x && getJoystickY(joy) == y) return;  // Joy hasn't changed
-
-	tx[joyData->x_low]  = lowByte(x);
-	tx[joyData->x_high] = highByte(x);
+	if (controls.joysticks[joyData->x] == x && controls.joysticks[joyData->y] == y) return;  // Joy hasn't changed
 
-	tx[joyData->y_low]  = lowByte(y);
-	tx[joyData->y_high] = highByte(y);
-
-	newData = true;
+	// Both axes together, so a frame-synced report can't pack half of it
+	const uint32_t irq = XInputLib_IRQSave();
+	controls.joysticks[joyData->x] = x;
+	controls.joysticks[joyData->y] = y;
+	XInputLib_IRQRestore(irq);
 	autosend();
 }
 
 void XInputController::releaseAll() {
-	const uint8_t offset = 2;  // Skip message type and packet size
-	memset(tx + offset, 0x00, sizeof(tx) - offset);  // Clear TX array
-	newData = true;  // Data changed and is unsent
+	const uint32_t irq = XInputLib_IRQSave();
+	controls = ControlState();  // Clear all controls
+	XInputLib_IRQRestore(irq);
+	dpadHeld = 0;
 	autosend();
 }
 
+void XInputController::setSOCDMode(XInputSOCD mode) {
+	socdMode = mode;
+}
+
+XInputSOCD XInputController::getSOCDMode() const {
+	return socdMode;
+}
+
+XInputController::SOCDState * XInputController::getSOCDFromEnum(XInputControl ctrl) {
+	switch (ctrl) {
+	case(JOY_LEFT): return &socdJoyLeft;
+	case(JOY_RIGHT): return &socdJoyRight;
+	default: return &socdDpad;
+	}
+}
+
+void XInputController::cleanSOCD(SOCDState & state, boolean useSOCD, boolean & up, boolean & down, boolean & left, boolean & right) const {
+	resolveSOCDAxis(state.vertical, socdMode, useSOCD, true, up, down);  // Up has priority
+	resolveSOCDAxis(state.horizontal, socdMode, useSOCD, false, left, right);  // Neutral
+}
+
 void XInputController::setAutoSend(boolean a) {
 	autoSendOption = a;
 }
 
+boolean XInputController::getAutoSend() const {
+	return autoSendOption;
+}
+
 boolean XInputController::getButton(uint8_t button) const {
 	const XInputMap_Button * buttonData = getButtonFromEnum((XInputControl) button);
 	if (buttonData == nullptr) return 0;  // Not a button
-	return tx[buttonData->index] & buttonData->mask;
+	return controls.buttons & buttonData->mask;
+}
+
+uint16_t XInputController::getButtons() const {
+	return controls.buttons;
 }
 
 boolean XInputController::getDpad(XInputControl dpad) const {
@@ -345,19 +570,19 @@ boolean XInputController::getDpad(XInputControl dpad) const {
 uint8_t XInputController::getTrigger(XInputControl trigger) const {
 	const XInputMap_Trigger * triggerData = getTriggerFromEnum(trigger);
 	if (triggerData == nullptr) return 0;  // Not a trigger
-	return tx[triggerData->index];
+	return (controls.triggers[triggerData->index] + 128) / 257;  // 16-bit to 8-bit, rounded
 }
 
 int16_t XInputController::getJoystickX(XInputControl joy) const {
 	const XInputMap_Joystick * joyData = getJoyFromEnum(joy);
 	if (joyData == nullptr) return 0;  // Not a joystick
-	return (tx[joyData->x_high] << 8) | tx[joyData->x_low];
+	return controls.joysticks[joyData->x];
 }
 
 int16_t XInputController::getJoystickY(XInputControl joy) const {
 	const XInputMap_Joystick * joyData = getJoyFromEnum(joy);
 	if (joyData == nullptr) return 0;  // Not a joystick
-	return (tx[joyData->y_high] << 8) | tx[joyData->y_low];
+	return controls.joysticks[joyData->y];
 }
 
 uint8_t XInputController::getPlayer() const {
@@ -392,29 +617,303 @@ boolean XInputController::connected() {
 #endif
 }
 
+void XInputController::setStateCallback(StateCallbackType cback) {
+	XInputLib_StateCallback = cback;
+}
+
+XInputUSBState XInputController::getUSBState() {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	return (XInputUSBState) XInputUSB::state();
+#else
+	return XInputUSBState::Powered;
+#endif
+}
+
+uint32_t XInputController::getUSBStateTime(XInputUSBState state) {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	return XInputUSB::stateMillis((uint8_t) state);
+#else
+	(void) state;
+	return 0;
+#endif
+}
+
+void XInputController::setStallWatchdog(uint16_t flushMs, uint16_t reconnectMs) {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	XInputUSB::setWatchdog(flushMs, reconnectMs);
+#else
+	(void) flushMs;
+	(void) reconnectMs;
+#endif
+}
+
+uint32_t XInputController::getRecoveryTime() {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	return XInputUSB::recoveryTime();
+#else
+	return 0;
+#endif
+}
+
+uint32_t XInputController::getWakeupTime() {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	return XInputUSB::wakeupTime();
+#else
+	return 0;
+#endif
+}
+
+void XInputController::hostLost(boolean reset) {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	XInputUSB::discard(usbIndex);
+#endif
+	resend = true;  // Not tx: transmit() could be copying into it
+	memset((void*) rumble, 0x00, sizeof(rumble));
+	if (reset) {
+		player = 0;  // Assigned again once the host enumerates
+		ledPattern = XInputLEDPattern::Off;
+	}
+}
+
+boolean XInputController::suspended() {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	return XInputUSB::suspended();
+#else
+	return false;
+#endif
+}
+
+uint32_t XInputController::frameCount() {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	return XInputUSB::frameCount();
+#else
+	return millis();  // Full speed frames are 1 ms
+#endif
+}
+
+void XInputController::setRecorder(XInputRecorder * rec) {
+	recorder = rec;
+}
+
+void XInputController::setMirror(XInputJoystickMirror * m) {
+	mirror = m;
+	tx[1] = 0x00;  // Never the report size, so the next send goes out and starts the copy
+}
+
+uint8_t XInputController::getIndex() const {
+	return usbIndex;
+}
+
+// Sends all registered controllers with pending data back-to-back,
+// so every player's report lands in the same USB frame
+void XInputController::sendAll() {
+	for (uint8_t i = 0; i < MaxControllers; i++) {
+		if (XInputLib_Instances[i] != nullptr) {
+			XInputLib_Instances[i]->send();
+		}
+	}
+}
+
+// Serializes the control state, with any overlay, into the 20-byte USB report
+void XInputController::packReport(uint8_t * report, uint16_t * dither) const {
+	ControlState state = controls;
+	state.buttons = (state.buttons & ~remapRelease) | remapPress;
+
+	const XInputProfile * const p = profile;
+	if (p != nullptr) {
+		uint16_t out = 0;
+		uint16_t in = state.buttons;
+		for (uint8_t bit = 0; in != 0; bit++, in >>= 1) {
+			if (!(in & 1)) continue;
+			const uint16_t mapped = p->buttons[bit];
+			out |= mapped ? mapped : (1 << bit);  // Zero leaves the button as-is
+		}
+		state.buttons = out & ~XInputProfile::Drop;
+	}
+
+	const Overlay * const o = overlay;
+	if (o != nullptr) {
+		state.buttons = (state.buttons & ~o->release) | o->press;
+		if (o->analog & Overlay::TriggerLeft)  state.triggers[Map_TriggerLeft.index]  = o->triggers[Map_TriggerLeft.index] * 257;
+		if (o->analog & Overlay::TriggerRight) state.triggers[Map_TriggerRight.index] = o->triggers[Map_TriggerRight.index] * 257;
+		if (o->analog & Overlay::JoyLeft) {
+			state.joysticks[Map_JoystickLeft.x] = o->joysticks[Map_JoystickLeft.x];
+			state.joysticks[Map_JoystickLeft.y] = o->joysticks[Map_JoystickLeft.y];
+		}
+		if (o->analog & Overlay::JoyRight) {
+			state.joysticks[Map_JoystickRight.x] = o->joysticks[Map_JoystickRight.x];
+			state.joysticks[Map_JoystickRight.y] = o->joysticks[Map_JoystickRight.y];
+		}
+	}
+
+	report[0] = 0x00;  // Message type
+	report[1] = 0x14;  // Packet size (20)
+	report[2] = lowByte(state.buttons);
+	report[3] = highByte(state.buttons);
+	for (uint8_t i = 0; i < 2; i++) {
+		// 65535 / 257 = 255, so full scale in is full scale out
+		if (dither != nullptr) {
+			const uint32_t sum = state.triggers[i] + dither[i];  // Below 65535 + 257, fits in 8 bits
+			const uint8_t out = sum / 257;
+			dither[i] = sum - out * 257;
+			report[4 + i] = out;
+		}
+		else {
+			report[4 + i] = (state.triggers[i] + 128) / 257;
+		}
+	}
+	for (uint8_t i = 0; i < 4; i++) {
+		report[6 + i * 2] = lowByte(state.joysticks[i]);
+		report[7 + i * 2] = highByte(state.joysticks[i]);
+	}
+	memset(report + 14, 0x00, sizeof(tx) - 14);  // Unused
+}
+
+void XInputController::setSendCallback(SendCallbackType cback) {
+	sendCallback = cback;
+}
+
+void XInputController::setButtonRemap(uint16_t press, uint16_t release) {
+	remapPress = press;
+	remapRelease = release;
+}
+
+void XInputController::setOverlay(const Overlay * o) {
+	overlay = o;
+}
+
+void XInputController::setFrameSync(boolean sync) {
+	frameSync = sync;
+}
+
+void XInputController::setTriggerDither(boolean dither) {
+	ditherOption = dither;
+	if (!dither) memset(ditherError, 0x00, sizeof(ditherError));
+}
+
 //Send an update packet to the PC
 int XInputController::send() {
-	if (!newData) return 0;  // TX data hasn't changed
+	if (frameSync) {
+		// No frames while the host is asleep, so a press has to wake it here
+		if (suspended()) flush();
+		return 0;  // Sent by pushFrame() on the next USB frame
+	}
+	return transmit(false);
+}
+
+// Sends from the USB frame (SOF) interrupt, so it must not block
+int XInputController::pushFrame() {
+	return transmit(true);
+}
+
+int XInputController::flush() {
+	if (!frameSync) return transmit(false);
+
+	const uint32_t irq = XInputLib_IRQSave();  // Otherwise pushFrame() could send in the middle
+	const int result = transmit(true);
+	XInputLib_IRQRestore(irq);
+	return result;
+}
+
 #if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
-	newData = false;
-	return XInputUSB::send(tx, sizeof(tx));
-#elif defined(XINPUT_DEBUG)
-	printDebug();
-	return sizeof(tx);
+// Queues a report, paired with its joystick copy if there is one. 'wait'
+// blocks for room, otherwise it's safe to call from the frame interrupt.
+static int XInputLib_Send(const uint8_t * report, uint8_t nbytes, const uint8_t * joystick, uint8_t index, boolean wait) {
+#ifndef XINPUT_MIRROR_SIMULATED
+	if (joystick != nullptr) {
+		return wait ? XInputUSB::mirrorSend(report, nbytes, joystick, index) : XInputUSB::mirrorTrySend(report, nbytes, joystick, index);
+	}
 #else
-    return sizeof(tx);
+	(void) joystick;  // No joystick interface, XInput only
+#endif
+	return wait ? XInputUSB::send(report, nbytes, index) : XInputUSB::trySend(report, nbytes, index);
+}
+#endif
+
+int XInputController::transmit(boolean fromFrame) {
+	if (sendCallback != nullptr) {
+		sendCallback(*this);
+	}
+
+	// Taken before sending. A host loss from here on sets it again, so a
+	// report it discards goes out once more.
+	const uint32_t irq = XInputLib_IRQSave();
+	const boolean forced = resend;
+	resend = false;
+	XInputLib_IRQRestore(irq);
+
+	uint8_t report[sizeof(tx)];
+	uint16_t error[2] = { ditherError[0], ditherError[1] };
+	packReport(report, ditherOption ? error : nullptr);
+	if (!forced && memcmp(report, tx, sizeof(tx)) == 0) {
+		memcpy(ditherError, error, sizeof(ditherError));  // Host keeps the same values
+		sendHeld = false;
+		return 0;  // Report hasn't changed
+	}
+
+	XInputJoystickMirror * const m = mirror;
+	uint8_t joystick[XInputJoystickMirror::Size];
+	if (m != nullptr) m->translate(report, joystick);
+
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	if (XInputUSB::suspended()) {
+		// A new press wakes the host. The report is sent once the bus
+		// resumes, as tx still holds what the host last saw.
+		const uint16_t pressed = (report[2] | report[3] << 8) & ~(tx[2] | tx[3] << 8);
+		if (pressed != 0) XInputUSB::wakeup();
+		sendHeld = true;
+		if (forced) resend = true;
+		return 0;
+	}
+
+	int result;
+	if (fromFrame) {
+		result = XInputLib_Send(report, sizeof(report), m != nullptr ? joystick : nullptr, usbIndex, false);
+	}
+	else {
+		const uint32_t start = micros();
+		result = XInputLib_Send(report, sizeof(report), m != nullptr ? joystick : nullptr, usbIndex, true);
+		const uint32_t elapsed = micros() - start;
+
+		sendTimeLast = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+		if (sendTimeLast > sendTimeMax) sendTimeMax = sendTimeLast;
+	}
+	sendHeld = (result == 0);  // Queue full, the host is still there
+	if (result <= 0) {
+		if (forced) resend = true;
+		return result;  // Not sent, try again next time
+	}
+#else
+	(void) fromFrame;
+	const int result = sizeof(tx);
+#endif
+
+	memcpy(tx, report, sizeof(tx));
+	memcpy(ditherError, error, sizeof(ditherError));
+	if (m != nullptr) {
+		memcpy(m->last, joystick, sizeof(m->last));
+	}
+	if (recorder != nullptr) {
+		recorder->record(tx, frameCount());
+	}
+
+#if defined(XINPUT_DEBUG_PRINT) && !(defined(USB_XINPUT) || defined(XINPUT_INTERFACE))
+	printDebug();  // Formatted text, slow
+#elif defined(XINPUT_DEBUG) && !(defined(USB_XINPUT) || defined(XINPUT_INTERFACE))
+	printTelemetry();
 #endif
+	return result;
 }
 
 int XInputController::receive() {
 #if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
-	if (XInputUSB::available() == 0) {
+	if (XInputUSB::available(usbIndex) == 0) {
 		return 0;  // No packet available
 	}
 
 	// Grab packet and store it in rx array
 	uint8_t rx[8];
-	const int bytesRecv = XInputUSB::recv(rx, sizeof(rx));
+	const int bytesRecv = XInputUSB::recv(rx, sizeof(rx), usbIndex);
 
 	// Only process if received 3 or more bytes (min valid packet size)
 	if (bytesRecv >= 3) {
@@ -481,6 +980,15 @@ XInputController::Range * XInputController::getRangeFromEnum(XInputControl ctrl)
 	}
 }
 
+boolean XInputController::getRange(XInputControl ctrl, int32_t & rangeMin, int32_t & rangeMax) const {
+	const Range * range = const_cast<XInputController*>(this)->getRangeFromEnum(ctrl);
+	if (range == nullptr) return false;  // Not an addressable range
+
+	rangeMin = range->min;
+	rangeMax = range->max;
+	return true;
+}
+
 int32_t XInputController::rescaleInput(int32_t val, Range in, Range out) {
 	if (val <= in.min) return out.min;  // Out of range -
 	if (val >= in.max) return out.max;  // Out of range +
@@ -508,12 +1016,146 @@ void XInputController::setRange(XInputControl ctrl, int32_t rangeMin, int32_t ra
 	range->max = rangeMax;
 }
 
+int8_t XInputController::getShapeIndex(XInputControl ctrl) {
+	switch (ctrl) {
+	case(TRIGGER_LEFT): return 0;
+	case(TRIGGER_RIGHT): return 1;
+	case(JOY_LEFT): return 2;
+	case(JOY_RIGHT): return 3;
+	default: return -1;
+	}
+}
+
+XInputController::Shape * XInputController::getShapeFromEnum(XInputControl ctrl) {
+	const int8_t index = getShapeIndex(ctrl);
+	if (index < 0) return nullptr;
+	return &shapes[index];
+}
+
+boolean XInputController::getShaping(XInputControl ctrl, uint16_t & inner, uint16_t & outer, uint16_t & anti, XInputCurve & curve) const {
+	const int8_t index = getShapeIndex(ctrl);
+	if (index < 0) return false;  // Not a shapeable control
+
+	const Shape & shape = shapes[index];
+	inner = shape.inner;
+	outer = shape.outer;
+	anti = shape.anti;
+	curve = shape.curve;
+	return true;
+}
+
+// The profile's table wins over the controller's own settings
+const XInputShapeTable * XInputController::getShapeTable(XInputControl ctrl) const {
+	const int8_t index = getShapeIndex(ctrl);
+	if (index < 0) return nullptr;
+
+	const XInputProfile * const p = profile;
+	if (p != nullptr && p->shapes[index] != nullptr) return p->shapes[index];
+
+	const Shape & shape = shapes[index];
+	return shape.enabled ? &shape.table : nullptr;
+}
+
+void XInputController::setCalibration(XInputCalibration * cal) {
+	calibration = cal;
+}
+
+void XInputController::setProfile(const XInputProfile * p) {
+	profile = p;
+}
+
+const XInputProfile * XInputController::getProfile() const {
+	return profile;
+}
+
+int32_t XInputController::invertAxis(int32_t val, Range range) {
+	return (range.max + range.min) - val;  // Mirrors around the center, keeps the range
+}
+
+void XInputController::setDeadzone(XInputControl ctrl, uint16_t inner, uint16_t outer) {
+	if (inner >= outer || outer > 1000) return;  // Error: Outer < Inner, or out of range
+
+	Shape * shape = getShapeFromEnum(ctrl);
+	if (shape == nullptr) return;  // Not a shapeable control
+
+	shape->inner = inner;
+	shape->outer = outer;
+	buildShape(*shape, getJoyFromEnum(ctrl) != nullptr);
+}
+
+void XInputController::setAntiDeadzone(XInputControl ctrl, uint16_t anti) {
+	if (anti >= 1000) return;  // Error: Out of range
+
+	Shape * shape = getShapeFromEnum(ctrl);
+	if (shape == nullptr) return;  // Not a shapeable control
+
+	shape->anti = anti;
+	buildShape(*shape, getJoyFromEnum(ctrl) != nullptr);
+}
+
+void XInputController::setCurve(XInputControl ctrl, XInputCurve curve) {
+	Shape * shape = getShapeFromEnum(ctrl);
+	if (shape == nullptr) return;  // Not a shapeable control
+
+	shape->curve = curve;
+	buildShape(*shape, getJoyFromEnum(ctrl) != nullptr);
+}
+
+// Bakes the shaping settings into a lookup table so that the per-sample cost
+// is one table interpolation. Joysticks are shaped radially: the table is
+// indexed by stick magnitude and holds the gain to apply to both axes, so
+// diagonals keep their direction. Triggers are shaped on a 16-bit scale
+// and the table holds the output value directly.
+void XInputController::buildShape(Shape & shape, boolean radial) {
+	shape.enabled = !(shape.inner == 0 && shape.outer == 1000 && shape.anti == 0 && shape.curve == XInputCurve::Linear);
+	if (!shape.enabled) return;  // Pass-through, table unused
+
+	XInputShapeTable & table = shape.table;
+	table.threshold = XInputShapeTable::scale(shape.inner, radial);
+	for (uint8_t i = 0; i <= XInputShapeTable::Segments; i++) {
+		table.values[i] = XInputShapeTable::entry(i, shape.inner, shape.outer, shape.anti, shape.curve, radial);
+	}
+}
+
+void XInputController::shapeJoystick(const XInputShapeTable * table, int32_t & x, int32_t & y) {
+	if (table == nullptr) return;  // Pass-through
+
+	const uint32_t mag = estimateMagnitude(x, y);
+	if (mag <= table->threshold) {
+		x = 0;
+		y = 0;
+		return;
+	}
+
+	uint32_t i = mag >> 10;
+	uint32_t frac = mag & 1023;
+	if (i >= XInputShapeTable::Segments) { i = XInputShapeTable::Segments - 1; frac = 1023; }
+
+	const int32_t g0 = table->values[i];
+	const int32_t gain = g0 + (((table->values[i + 1] - g0) * (int32_t) frac) >> 10);
+
+	const Range & range = XInputMap_Joystick::range;
+	x = constrain((x * gain) >> 12, range.min, range.max);
+	y = constrain((y * gain) >> 12, range.min, range.max);
+}
+
+int32_t XInputController::shapeTrigger(const XInputShapeTable * table, int32_t val) {
+	if (table == nullptr) return val;  // Pass-through
+
+	const uint32_t in = val;  // Already 16-bit
+	if (in <= table->threshold) return 0;
+
+	const uint32_t i = in >> 10;
+	const int32_t frac = in & 1023;
+	const int32_t t0 = table->values[i];
+	return t0 + (((table->values[i + 1] - t0) * frac) >> 10);
+}
+
 // Resets class back to initial values
 void XInputController::reset() {
-	// Reset control data (tx)
-	releaseAll();  // Clear TX buffer
-	tx[0] = 0x00;  // Set tx message type
-	tx[1] = 0x14;  // Set tx packet size (20)
+	// Reset control data. The last sent report (tx) is kept, so
+	// the cleared state is sent if it differs from what the host has.
+	releaseAll();
 
 	// Reset received data (rx)
 	player = 0;  // Not connected, no player
@@ -524,8 +1166,32 @@ void XInputController::reset() {
 	setTriggerRange(XInputMap_Trigger::range.min, XInputMap_Trigger::range.max);
 	setJoystickRange(XInputMap_Joystick::range.min, XInputMap_Joystick::range.max);
 
+	// Reset response shaping
+	for (Shape & shape : shapes) {
+		shape.inner = 0;
+		shape.outer = 1000;
+		shape.anti = 0;
+		shape.curve = XInputCurve::Linear;
+		shape.enabled = false;
+	}
+	profile = nullptr;
+	calibration = nullptr;
+
+	// Reset SOCD press order
+	socdMode = XInputSOCD::UpPriority;
+	socdDpad = socdJoyLeft = socdJoyRight = SOCDState();
+
+	// Reset send timing
+	sendTimeLast = sendTimeMax = 0;
+	overlay = nullptr;
+	frameSync = false;
+	ditherOption = false;
+	memset(ditherError, 0x00, sizeof(ditherError));
+	remapPress = remapRelease = 0;
+
 	// Clear user-set options
 	recvCallback = nullptr;
+	sendCallback = nullptr;
 	autoSendOption = true;
 }
 
@@ -585,4 +1251,24 @@ void XInputController::printDebug(Print &output) const {
 	output.println(buffer);
 }
 
+void XInputController::getTelemetry(XInputTelemetryFrame & frame) const {
+	uint16_t error[2] = { ditherError[0], ditherError[1] };  // Not advanced, this report isn't sent
+	packReport(frame.report, ditherOption ? error : nullptr);
+	frame.rumbleLeft = getRumbleLeft();
+	frame.rumbleRight = getRumbleRight();
+	frame.ledPattern = (uint8_t) getLEDPattern();
+	frame.player = getPlayer();
+	frame.frame = frameCount();
+	frame.sendTimeLast = sendTimeLast;
+	frame.sendTimeMax = sendTimeMax;
+}
+
+void XInputController::printTelemetry(Print &output) const {
+	XInputTelemetryFrame frame;
+	getTelemetry(frame);
+
+	uint8_t buffer[XInputTelemetry::FrameSize];
+	output.write(buffer, XInputTelemetry::encode(frame, buffer));
+}
+
 XInputController XInput;
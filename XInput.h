@@ -0,0 +1,387 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_LIBRARY_H
+#define XINPUT_LIBRARY_H
+
+#include <Arduino.h>
+
+class XInputRecorder;
+class XInputJoystickMirror;
+struct XInputTelemetryFrame;
+struct XInputProfile;
+class XInputCalibration;
+
+enum XInputControl : uint8_t {
+	BUTTON_LOGO = 0,
+	BUTTON_A = 1,
+	BUTTON_B = 2,
+	BUTTON_X = 3,
+	BUTTON_Y = 4,
+	BUTTON_LB = 5,
+	BUTTON_RB = 6,
+	BUTTON_BACK = 7,
+	BUTTON_START = 8,
+	BUTTON_L3 = 9,
+	BUTTON_R3 = 10,
+	DPAD_UP = 11,
+	DPAD_DOWN = 12,
+	DPAD_LEFT = 13,
+	DPAD_RIGHT = 14,
+	TRIGGER_LEFT = 15,
+	TRIGGER_RIGHT = 16,
+	JOY_LEFT,
+	JOY_RIGHT,
+};
+
+enum class XInputReceiveType : uint8_t {
+	Rumble = 0x00,
+	LEDs = 0x01,
+};
+
+enum class XInputLEDPattern : uint8_t {
+	Off = 0x00,
+	Blinking = 0x01,
+	Flash1 = 0x02,
+	Flash2 = 0x03,
+	Flash3 = 0x04,
+	Flash4 = 0x05,
+	On1 = 0x06,
+	On2 = 0x07,
+	On3 = 0x08,
+	On4 = 0x09,
+	Rotating = 0x0A,
+	BlinkOnce = 0x0B,
+	BlinkSlow = 0x0C,
+	Alternating = 0x0D,  // Blinks, but with previous state
+};
+
+enum class XInputCurve : uint8_t {
+	Linear = 0,     // Output follows input
+	Quadratic = 1,  // Finer control near center
+	Cubic = 2,      // Even finer control near center
+	Aggressive = 3, // Faster response near center
+};
+
+enum class XInputSOCD : uint8_t {
+	UpPriority = 0,  // Up + Down = Up, Left + Right = Neutral
+	Neutral = 1,     // Opposite directions cancel out
+	LastInput = 2,   // Most recently pressed direction wins
+	FirstInput = 3,  // Direction held first wins
+};
+
+// USB device states, as in the specification (USB 2.0, 9.1.1)
+enum class XInputUSBState : uint8_t {
+	Powered = 0,     // Attached, not reset by the host yet
+	Default = 1,     // Reset, not addressed
+	Address = 2,     // Addressed, not configured
+	Configured = 3,  // Ready to send
+	Suspended = 4,   // Host asleep, returns to the previous state on resume
+};
+
+// Response shaping lookup table. The math is constexpr so tables can be
+// built at compile time too, see XINPUT_JOYSTICK_SHAPE() in XInputProfile.h
+struct XInputShapeTable {
+	static const uint8_t Segments = 64;  // Linearly interpolated
+	static const uint16_t Step = 1024;  // Input units per segment
+
+	uint16_t threshold;  // Inner deadzone in input units, below which output is 0
+	uint16_t values[Segments + 1];  // Joysticks: gain (Q12). Triggers: output value.
+
+	// Joysticks are shaped by magnitude, triggers on a 16-bit scale
+	static constexpr uint32_t full(bool radial) { return radial ? 32767 : 0xFFFF; }
+	static constexpr uint32_t scale(uint16_t permille, bool radial) { return (permille * full(radial)) / 1000; }
+
+	// Q15 in, Q15 out, both spanning 0 - 32768
+	static constexpr uint32_t curve(XInputCurve c, uint32_t s) {
+		return c == XInputCurve::Quadratic  ? (s * s) >> 15 :
+		       c == XInputCurve::Cubic      ? (((s * s) >> 15) * s) >> 15 :
+		       c == XInputCurve::Aggressive ? 32768 - (((32768 - s) * (32768 - s)) >> 15) :
+		       s;
+	}
+
+	// Table value 'i', with deadzones and anti-deadzone in per-mille
+	static constexpr uint16_t entry(uint8_t i, uint16_t inner, uint16_t outer, uint16_t anti, XInputCurve c, bool radial) {
+		return finish(input(i, scale(inner, radial)),
+			output(input(i, scale(inner, radial)), scale(inner, radial), scale(outer, radial), scale(anti, radial), c, full(radial)),
+			radial);
+	}
+
+private:
+	// Values below the deadzone are handled by the threshold
+	static constexpr uint32_t input(uint8_t i, uint32_t inner) {
+		return (uint32_t) i * Step < inner ? inner : (i == 0 ? 1 : (uint32_t) i * Step);
+	}
+	static constexpr uint32_t output(uint32_t in, uint32_t inner, uint32_t outer, uint32_t anti, XInputCurve c, uint32_t full) {
+		return in < outer ? anti + (((full - anti) * curve(c, ((in - inner) << 15) / (outer - inner))) >> 15) : full;
+	}
+	static constexpr uint16_t finish(uint32_t in, uint32_t out, bool radial) {
+		return radial ? clamp((out << 12) / in) : clamp(out);
+	}
+	static constexpr uint16_t clamp(uint32_t v) { return v > 0xFFFF ? 0xFFFF : v; }
+};
+
+class XInputController {
+public:
+	static const uint8_t MaxControllers = 4;  // USB interfaces, see USB_XINPUT_X4
+
+	XInputController(uint8_t index = 0);  // USB interface index, 0 is the first
+
+	void begin();
+
+	// Set Control Surfaces
+	void press(uint8_t button);
+	void release(uint8_t button);
+	void setButton(uint8_t button, boolean state);
+	void setButtons(uint16_t buttons, uint16_t mask = 0xFFFF);  // Report-ordered, see getButtonMask()
+	static uint16_t getButtonMask(uint8_t button);  // Bit for the button in setButtons(), 0 if none
+
+	void setDpad(XInputControl pad, boolean state);
+	void setDpad(boolean up, boolean down, boolean left, boolean right, boolean useSOCD = true);
+
+	void setTrigger(XInputControl trigger, int32_t val);
+
+	void setJoystick(XInputControl joy, int32_t x, int32_t y);
+	void setJoystick(XInputControl joy, boolean up, boolean down, boolean left, boolean right, boolean useSOCD = true);
+
+	void releaseAll();
+
+	// Simultaneous Opposite Cardinal Directions (SOCD) Cleaning
+	void setSOCDMode(XInputSOCD mode);
+	XInputSOCD getSOCDMode() const;
+
+	// Auto-Send Data
+	void setAutoSend(boolean a);
+	boolean getAutoSend() const;
+
+	// Read Control Surfaces
+	boolean getButton(uint8_t button) const;
+	uint16_t getButtons() const;  // Report-ordered, see getButtonMask()
+	boolean getDpad(XInputControl dpad) const;
+	uint8_t getTrigger(XInputControl trigger) const;
+	int16_t getJoystickX(XInputControl joy) const;
+	int16_t getJoystickY(XInputControl joy) const;
+
+	// Received Data
+	uint8_t getPlayer() const;  // Player # assigned to the controller (0 is unassigned)
+
+	uint16_t getRumble() const;  // Rumble motors. MSB is large weight, LSB is small
+	uint8_t  getRumbleLeft() const;  // Large rumble motor, left grip
+	uint8_t  getRumbleRight() const; // Small rumble motor, right grip
+
+	XInputLEDPattern getLEDPattern() const;  // Returns LED pattern type
+
+	// Received Data Callback
+	using RecvCallbackType = void(*)(uint8_t packetType);
+	void setReceiveCallback(RecvCallbackType);
+
+	// Send Callback, run before each report is packed
+	using SendCallbackType = void(*)(XInputController & controller);
+	void setSendCallback(SendCallbackType);
+
+	// Button Remap, applied to the button word before any overlay
+	void setButtonRemap(uint16_t press, uint16_t release);
+
+	// USB IO
+	boolean connected();
+	int send();
+	int receive();
+	static void sendAll();  // Send all controllers with new data
+	uint8_t getIndex() const;
+	static uint32_t frameCount();  // USB frames (ms) since power-up
+	static boolean suspended();  // Host is asleep. Pressing a button wakes it, if allowed.
+	static uint32_t getWakeupTime();  // ms from the last wakeup press to the first report the host took
+
+	// USB Device State. The callback runs from the USB interrupt, after the
+	// controllers have dropped their queued reports and rumble on a loss.
+	using StateCallbackType = void(*)(XInputUSBState state, XInputUSBState previous);
+	static void setStateCallback(StateCallbackType);
+	static XInputUSBState getUSBState();
+	static uint32_t getUSBStateTime(XInputUSBState state);  // millis() when last entered
+
+	// Stall Watchdog, off by default. A report the host doesn't take for
+	// 'flushMs' drops the queue. If it's still stuck 'reconnectMs' later,
+	// the device disconnects and enumerates again. 0 disables either.
+	static void setStallWatchdog(uint16_t flushMs, uint16_t reconnectMs = 0);
+	static uint32_t getRecoveryTime();  // ms from the last stall to the first report taken after it
+
+	// Frame-Synced Sending
+	// With frame sync on, send() does nothing and pushFrame(), called every USB
+	// frame (SOF), sends the report instead. While the host is asleep there
+	// are no frames, so send() still checks for a press to wake it. The overlay is applied on top of
+	// the control state as the report is packed, without changing it.
+	struct Overlay {
+		static const uint8_t TriggerLeft = 0x01;  // 'analog' flags
+		static const uint8_t TriggerRight = 0x02;
+		static const uint8_t JoyLeft = 0x04;
+		static const uint8_t JoyRight = 0x08;
+
+		uint16_t press;    // Buttons forced on, report-ordered
+		uint16_t release;  // Buttons forced off
+		uint8_t analog;    // Analog controls replaced by the values below
+		uint8_t triggers[2];
+		int16_t joysticks[4];  // Left X, Y, right X, Y
+	};
+
+	void setFrameSync(boolean sync);
+	void setTriggerDither(boolean dither);  // Diffuse the 16-bit trigger's low bits across reports
+	void setOverlay(const Overlay * overlay);
+	int pushFrame();
+
+	// Sends the report now from loop(), even with frame sync on. The frame
+	// interrupt is held off while it packs and queues, so it can't send at
+	// the same time. sendPending() is true while a changed report is waiting
+	// for room in the USB queue or for the host to wake.
+	int flush();
+	boolean sendPending() const { return sendHeld; }
+
+	// Report Recording
+	void setRecorder(XInputRecorder * rec);
+
+	// DirectInput Mirror, see XInputDirectInput.h. Each changed report is
+	// copied to the joystick and both are sent together.
+	void setMirror(XInputJoystickMirror * mirror);  // nullptr to stop
+
+	// Control Input Ranges
+	struct Range { int32_t min; int32_t max; };
+
+	void setTriggerRange(int32_t rangeMin, int32_t rangeMax);
+	void setJoystickRange(int32_t rangeMin, int32_t rangeMax);
+	void setRange(XInputControl ctrl, int32_t rangeMin, int32_t rangeMax);
+	boolean getRange(XInputControl ctrl, int32_t & rangeMin, int32_t & rangeMax) const;  // false if not ranged
+
+	// Response Shaping (deadzones in per-mille of full deflection, 0-1000)
+	void setDeadzone(XInputControl ctrl, uint16_t inner, uint16_t outer = 1000);
+	void setAntiDeadzone(XInputControl ctrl, uint16_t anti);
+	void setCurve(XInputControl ctrl, XInputCurve curve);
+	boolean getShaping(XInputControl ctrl, uint16_t & inner, uint16_t & outer, uint16_t & anti, XInputCurve & curve) const;
+
+	// Per-Axis Calibration, see XInputCalibration.h
+	void setCalibration(XInputCalibration * calibration);  // nullptr to use the input ranges
+
+	// Mapping Profile, see XInputProfile.h. Switching is one pointer swap.
+	void setProfile(const XInputProfile * profile);  // nullptr for no mapping
+	const XInputProfile * getProfile() const;
+
+	// Setup
+	void reset();
+
+	// Debug
+	void printDebug(Print& output = Serial) const;
+	void printTelemetry(Print& output = Serial) const;  // Binary, see XInputTelemetry.h
+	void getTelemetry(XInputTelemetryFrame & frame) const;
+
+private:
+	// Control State, packed into the report on send
+	struct ControlState {
+		uint16_t buttons;       // Button bits, in report order (tx[2] is the LSB)
+		uint16_t triggers[2];   // Left, right (16-bit, reduced to 8 when packed)
+		int16_t  joysticks[4];  // Left X, Y, right X, Y
+	};
+	ControlState controls;
+
+	// Trigger Dither (error carried into the next report, per trigger)
+	boolean ditherOption;
+	uint16_t ditherError[2];
+
+	// Sent Data
+	uint8_t tx[20];  // Last report sent to the host
+	boolean autoSendOption;  // Flag for automatically sending data
+
+	void packReport(uint8_t * report, uint16_t * dither = nullptr) const;  // Rounds triggers if no dither state
+	int transmit(boolean fromFrame);
+
+	const Overlay * volatile overlay;  // Applied when packing, if set
+	volatile boolean frameSync;  // Send from pushFrame() only
+	volatile boolean sendHeld;  // Last changed report wasn't queued
+	volatile boolean resend;  // Host dropped tx, send the next report even if unchanged
+
+	SendCallbackType sendCallback;  // User-set callback before sending
+	volatile uint16_t remapPress, remapRelease;  // Button word remap
+
+	void setJoystickDirect(XInputControl joy, int16_t x, int16_t y);
+
+	inline void autosend() {
+		if (autoSendOption) { send(); }
+	}
+
+	// SOCD Cleaning
+	struct SOCDState { uint8_t vertical, horizontal; };  // Press order per axis
+	XInputSOCD socdMode;
+	SOCDState socdDpad, socdJoyLeft, socdJoyRight;
+	uint8_t dpadHeld;  // Raw d-pad bits, before cleaning
+	SOCDState * getSOCDFromEnum(XInputControl ctrl);
+	void cleanSOCD(SOCDState & state, boolean useSOCD, boolean & up, boolean & down, boolean & left, boolean & right) const;
+
+	// Received Data
+	volatile uint8_t player;  // Gamepad player #, buffered
+	volatile uint8_t rumble[2];  // Rumble motor data in, buffered
+	volatile XInputLEDPattern ledPattern;  // LED pattern data in, buffered
+	RecvCallbackType recvCallback;  // User-set callback for received data
+
+	friend void XInputLib_State_Callback(uint8_t state, uint8_t previous);
+	void hostLost(boolean reset);  // Drop what the host hasn't taken
+
+	XInputRecorder * recorder;  // Records each sent report, if set
+	XInputJoystickMirror * mirror;  // Joystick copy sent with each report, if set
+
+	const uint8_t usbIndex;  // USB interface for this controller
+
+	// Send Timing (us)
+	uint16_t sendTimeLast, sendTimeMax;
+
+	void parseLED(uint8_t leds);  // Parse LED data and set pattern/player data
+
+	// Control Input Ranges
+	Range rangeTrigLeft, rangeTrigRight, rangeJoyLeft, rangeJoyRight;
+	Range * getRangeFromEnum(XInputControl ctrl);
+	static int32_t rescaleInput(int32_t val, Range in, Range out);
+
+	// Response Shaping
+	struct Shape {
+		boolean enabled;  // Pass-through if false
+		uint16_t inner, outer, anti;  // Per-mille of full deflection
+		XInputCurve curve;
+		XInputShapeTable table;
+	};
+
+	Shape shapes[4];  // Trigger left, right, joystick left, right
+	static int8_t getShapeIndex(XInputControl ctrl);
+	Shape * getShapeFromEnum(XInputControl ctrl);
+	const XInputShapeTable * getShapeTable(XInputControl ctrl) const;  // nullptr for pass-through
+	static void buildShape(Shape & shape, boolean radial);
+	static void shapeJoystick(const XInputShapeTable * table, int32_t & x, int32_t & y);
+	static int32_t shapeTrigger(const XInputShapeTable * table, int32_t val);
+
+	// Calibration and Mapping Profile
+	XInputCalibration * volatile calibration;
+	const XInputProfile * volatile profile;
+	static int32_t invertAxis(int32_t val, Range range);
+};
+
+extern XInputController XInput;
+
+#endif
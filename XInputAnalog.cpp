@@ -0,0 +1,259 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputAnalog.h"
+
+#ifdef XINPUT_ANALOG_PDB
+#include <DMAChannel.h>
+
+static DMAChannel dmaResult(false);  // ADC result to buffer
+static DMAChannel dmaMux(false);  // Next input to the ADC mux
+static uint8_t muxSequence[XInputAnalogSampler::MaxAxes];
+#endif
+
+// --------------------------------------------------------
+// XInputAnalogSampler Class                              |
+// --------------------------------------------------------
+
+XInputAnalogSampler * XInputAnalogSampler::active = nullptr;
+
+XInputAnalogSampler::XInputAnalogSampler(const XInputAnalogAxis * a, uint8_t count) :
+	axes(a), numAxes(count > MaxAxes ? MaxAxes : count),
+	oversampleShift(0), halfSize(0),
+	buffer(), results(), current(0), setCount(0), paused(false)
+#ifdef XINPUT_ANALOG_PDB
+	, pdbConfig(0), pdbMod(0)
+#endif
+#ifdef XINPUT_ANALOG_SIMULATED
+	, waveform(nullptr), simHalf(0), simSample(0)
+#endif
+{}
+
+boolean XInputAnalogSampler::begin(uint32_t rate, uint8_t oversample) {
+	if (numAxes == 0 || rate == 0) return false;  // Error: Nothing to sample
+	if (oversample == 0 || oversample > MaxOversample || (oversample & (oversample - 1))) return false;  // Error: Not a power of two
+
+	oversampleShift = 0;
+	while ((1 << oversampleShift) < oversample) oversampleShift++;
+	halfSize = numAxes * oversample;
+	setCount = 0;
+
+#if defined(XINPUT_ANALOG_PDB)
+	const uint32_t conversions = rate * halfSize;  // Per second
+	if (conversions > 100000) return false;  // Error: Faster than the ADC settings allow
+
+	end();
+	active = this;
+
+	analogReadResolution(12);
+	analogReadAveraging(1);  // Oversampling is done here instead
+
+	// Hardware triggered, so writing the mux doesn't start a conversion
+	ADC0_SC2 |= ADC_SC2_ADTRG | ADC_SC2_DMAEN;
+	ADC0_SC3 = 0;
+	ADC0_SC1A = axes[0].channel;
+
+	// The mux channel writes the input for the conversion after next
+	for (uint8_t i = 0; i < numAxes; i++) {
+		muxSequence[i] = axes[(i + 1) % numAxes].channel;
+	}
+
+	dmaResult.begin();
+	dmaResult.source(*(volatile uint16_t *) &ADC0_RA);
+	dmaResult.destinationBuffer(buffer, halfSize * 2 * sizeof(buffer[0]));
+	dmaResult.triggerAtHardwareEvent(DMAMUX_SOURCE_ADC0);
+	dmaResult.interruptAtHalf();
+	dmaResult.interruptAtCompletion();
+	dmaResult.attachInterrupt(isr);
+
+	dmaMux.begin();
+	dmaMux.sourceBuffer(muxSequence, numAxes);
+	dmaMux.destination(*(volatile uint8_t *) &ADC0_SC1A);
+	dmaMux.triggerAtTransfersOf(dmaResult);
+
+	dmaMux.enable();
+	dmaResult.enable();
+
+	// PDB, one trigger per conversion
+	uint8_t prescale = 0;
+	while (prescale < 7 && (F_BUS >> prescale) / conversions > 0xFFFF) prescale++;
+	const uint32_t mod = (F_BUS >> prescale) / conversions;
+	if (mod == 0 || mod > 0xFFFF) { end(); return false; }  // Error: Rate out of range
+
+	const uint32_t config = PDB_SC_TRGSEL(15) | PDB_SC_PDBEN | PDB_SC_CONT | PDB_SC_PRESCALER(prescale);
+	pdbConfig = config;
+	pdbMod = mod - 1;
+	paused = false;
+	SIM_SCGC6 |= SIM_SCGC6_PDB;
+	PDB0_MOD = mod - 1;
+	PDB0_IDLY = 0;
+	PDB0_SC = config | PDB_SC_LDOK;
+	PDB0_SC = config | PDB_SC_SWTRIG;
+	PDB0_CH0C1 = 0x0101;  // Pre-trigger 0 enabled, output on
+	return true;
+
+#elif defined(XINPUT_ANALOG_SIMULATED)
+	active = this;
+	paused = false;
+	simHalf = 0;
+	simSample = 0;
+	return true;
+
+#else
+	return false;  // No PDB (Teensy LC)
+#endif
+}
+
+void XInputAnalogSampler::end() {
+#ifdef XINPUT_ANALOG_PDB
+	if (paused) SIM_SCGC6 |= SIM_SCGC6_PDB;  // Registers fault while gated
+	PDB0_SC = 0;
+	dmaResult.disable();
+	dmaMux.disable();
+	ADC0_SC2 &= ~(ADC_SC2_ADTRG | ADC_SC2_DMAEN);
+#endif
+	paused = false;
+	if (active == this) active = nullptr;
+}
+
+void XInputAnalogSampler::pause() {
+	if (active != this || paused) return;  // Not running
+	paused = true;
+#ifdef XINPUT_ANALOG_PDB
+	PDB0_SC = 0;  // Stop triggering, the DMA waits where it is
+	SIM_SCGC6 &= ~SIM_SCGC6_PDB;
+#endif
+}
+
+void XInputAnalogSampler::resume() {
+	if (active != this || !paused) return;  // Not paused
+#ifdef XINPUT_ANALOG_PDB
+	SIM_SCGC6 |= SIM_SCGC6_PDB;
+	PDB0_MOD = pdbMod;
+	PDB0_IDLY = 0;
+	PDB0_SC = pdbConfig | PDB_SC_LDOK;
+	PDB0_SC = pdbConfig | PDB_SC_SWTRIG;
+	PDB0_CH0C1 = 0x0101;
+#endif
+	paused = false;
+}
+
+void XInputAnalogSampler::isr() {
+#ifdef XINPUT_ANALOG_PDB
+	const uintptr_t daddr = (uintptr_t) dmaResult.TCD->DADDR;
+	dmaResult.clearInterrupt();
+	if (active == nullptr) return;
+
+	// Writing the second half means the first half is done, and vice versa
+	const uintptr_t second = (uintptr_t) (active->buffer + active->halfSize);
+	active->complete(daddr >= second ? 0 : 1);
+#endif
+}
+
+void XInputAnalogSampler::complete(uint8_t half) {
+	const volatile uint16_t * samples = buffer + half * halfSize;
+	const uint8_t next = current ^ 1;
+
+	// Samples are interleaved by axis: a0, a1, ... a0, a1, ...
+	for (uint8_t a = 0; a < numAxes; a++) {
+		uint32_t sum = 0;
+		for (uint16_t i = a; i < halfSize; i += numAxes) {
+			sum += samples[i];
+		}
+		uint16_t value = sum >> oversampleShift;
+		if (axes[a].invert) value = (Resolution - 1) - value;
+		results[next][a] = value;
+	}
+
+	current = next;
+	setCount++;
+}
+
+boolean XInputAnalogSampler::read(uint16_t * values) const {
+	uint32_t count;
+	do {
+		count = setCount;
+		if (count == 0) return false;  // No complete set yet
+
+		const uint8_t c = current;
+		for (uint8_t a = 0; a < numAxes; a++) {
+			values[a] = results[c][a];
+		}
+	} while (count != setCount);  // Retry if a set completed mid-copy
+	return true;
+}
+
+uint16_t XInputAnalogSampler::read(uint8_t axis) const {
+	if (axis >= numAxes) return 0;  // Error: Not an axis
+	return results[current][axis];
+}
+
+void XInputAnalogSampler::update(XInputController & controller) const {
+	uint16_t values[MaxAxes];
+	if (!read(values)) return;  // Nothing sampled yet
+
+	const uint16_t center = Resolution / 2;
+	int32_t joy[2][2] = { { center, center }, { center, center } };  // [left/right][x/y]
+	boolean joyUsed[2] = { false, false };
+
+	// Apply everything, then send once
+	const boolean autoSend = controller.getAutoSend();
+	controller.setAutoSend(false);
+
+	for (uint8_t a = 0; a < numAxes; a++) {
+		const XInputControl ctrl = axes[a].control;
+		if (ctrl == JOY_LEFT || ctrl == JOY_RIGHT) {
+			const uint8_t j = (ctrl == JOY_RIGHT);
+			joy[j][axes[a].y ? 1 : 0] = values[a];
+			joyUsed[j] = true;
+		}
+		else {
+			controller.setTrigger(ctrl, values[a]);
+		}
+	}
+	if (joyUsed[0]) controller.setJoystick(JOY_LEFT, joy[0][0], joy[0][1]);
+	if (joyUsed[1]) controller.setJoystick(JOY_RIGHT, joy[1][0], joy[1][1]);
+
+	controller.setAutoSend(autoSend);
+	if (autoSend) controller.send();
+}
+
+#ifdef XINPUT_ANALOG_SIMULATED
+void XInputAnalogSampler::simulate(Waveform wave) {
+	waveform = wave;
+}
+
+void XInputAnalogSampler::tick() {
+	if (active != this || waveform == nullptr || paused) return;  // Not started, or paused
+
+	volatile uint16_t * samples = buffer + simHalf * halfSize;
+	for (uint16_t i = 0; i < halfSize; i++) {
+		samples[i] = waveform(i % numAxes, simSample++ / numAxes) & (Resolution - 1);
+	}
+	complete(simHalf);
+	simHalf ^= 1;
+}
+#endif
@@ -0,0 +1,129 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_ANALOG_H
+#define XINPUT_ANALOG_H
+
+#include "XInput.h"
+
+/*
+Samples the analog axes in the background, so the loop never waits on
+analogRead(). The PDB timer triggers one ADC0 conversion per tick and DMA
+stores each result into one half of a ping-pong buffer, while a second
+DMA channel writes the next axis's input into the ADC mux. Each time a
+half fills, its oversamples are averaged into the latest complete set.
+
+  const XInputAnalogAxis axes[] = {
+    { 5, JOY_LEFT, false },   // A0, X
+    { 14, JOY_LEFT, true },   // A1, Y
+    { 8, TRIGGER_LEFT },      // A2
+  };
+  XInputAnalogSampler sampler(axes, 3);
+
+  XInput.setJoystickRange(0, 4095);  // Values are 12-bit
+  XInput.setTriggerRange(0, 4095);
+  sampler.begin(1000, 4);  // 1 kHz sets, 4 samples per axis
+
+  sampler.update(XInput);  // In loop()
+
+Channels are ADC0 inputs (SC1A), not Arduino pins. On Teensy 3.x, A0-A9
+are inputs 5, 14, 8, 9, 13, 12, 6, 7, 15 and 4. The Teensy LC has no PDB
+and isn't supported. Without the hardware (e.g. on the host), the sampler
+is fed by a waveform function, one buffer half per tick().
+*/
+
+#if defined(PDB0_SC)
+#define XINPUT_ANALOG_PDB
+#elif !defined(KINETISL)
+#define XINPUT_ANALOG_SIMULATED
+#endif
+
+struct XInputAnalogAxis {
+	uint8_t channel;  // ADC0 input
+	XInputControl control;  // TRIGGER_LEFT/RIGHT or JOY_LEFT/RIGHT
+	boolean y;  // Joystick Y axis, X if false
+	boolean invert;  // Flip the reading
+};
+
+class XInputAnalogSampler {
+public:
+	static const uint8_t MaxAxes = 6;
+	static const uint8_t MaxOversample = 16;
+	static const uint16_t Resolution = 4096;  // 12-bit
+
+	XInputAnalogSampler(const XInputAnalogAxis * axes, uint8_t count);
+
+	// Sets per second, and samples averaged per axis in each set (power of two)
+	boolean begin(uint32_t rate = 1000, uint8_t oversample = 4);
+	void end();
+
+	// Stops sampling and gates the PDB clock, e.g. while the USB bus is
+	// suspended (see XInputUSB::setSuspendCallback). The last set is kept.
+	void pause();
+	void resume();
+
+	boolean read(uint16_t * values) const;  // Latest complete set, false if none yet
+	uint16_t read(uint8_t axis) const;
+	uint32_t sets() const { return setCount; }  // Completed sets
+
+	void update(XInputController & controller) const;  // Apply the latest set
+
+#ifdef XINPUT_ANALOG_SIMULATED
+	using Waveform = uint16_t(*)(uint8_t axis, uint32_t sample);  // Sample is counted per axis
+	void simulate(Waveform wave);
+	void tick();  // Fill and complete one buffer half, as the DMA would
+#endif
+
+private:
+	const XInputAnalogAxis * const axes;
+	const uint8_t numAxes;
+	uint8_t oversampleShift;
+	uint16_t halfSize;  // Samples per buffer half
+
+	volatile uint16_t buffer[2 * MaxAxes * MaxOversample];  // Ping-pong
+	volatile uint16_t results[2][MaxAxes];  // Averaged sets, one being written
+	volatile uint8_t current;  // Index of the last complete set
+	volatile uint32_t setCount;
+	boolean paused;
+
+#ifdef XINPUT_ANALOG_PDB
+	uint32_t pdbConfig;  // Restored on resume
+	uint16_t pdbMod;
+#endif
+
+	void complete(uint8_t half);
+
+	static XInputAnalogSampler * active;  // Instance served by the DMA interrupt
+	static void isr();
+
+#ifdef XINPUT_ANALOG_SIMULATED
+	Waveform waveform;
+	uint8_t simHalf;
+	uint32_t simSample;
+#endif
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputCalibration.h"
+
+#include <stddef.h>
+
+#if defined(__has_include)
+#if __has_include(<EEPROM.h>)
+#include <EEPROM.h>
+#define XINPUT_CALIBRATION_EEPROM
+#endif
+#endif
+
+// --------------------------------------------------------
+// XInput Calibration Storage                             |
+// (Raw points per axis, rebuilt into transforms on load) |
+// --------------------------------------------------------
+
+struct XInputCalibrationRecord {
+	static const uint16_t Magic = 0x4358;  // 'XC'
+
+	uint16_t magic;
+	uint16_t deadband;
+	uint8_t valid;
+	int32_t points[XInputCalibration::NumAxes][3];
+	uint8_t checksum;
+};
+
+#ifdef XINPUT_CALIBRATION_EEPROM
+static uint8_t calibrationChecksum(const XInputCalibrationRecord & r) {
+	const uint8_t * data = (const uint8_t *) &r;
+	uint8_t sum = 0;
+	for (size_t i = 0; i < offsetof(XInputCalibrationRecord, checksum); i++) {
+		sum = (sum << 1 | sum >> 7) ^ data[i];
+	}
+	return sum;
+}
+#endif
+
+// --------------------------------------------------------
+// XInputCalibration Class                                |
+// --------------------------------------------------------
+
+XInputCalibration::XInputCalibration(int address) :
+	points(), transforms(), validMask(0), deadband(20),
+	eepromAddress(address),
+	learningMode(false), restTarget(0), restCount(), restSum()
+{}
+
+boolean XInputCalibration::begin() {
+#ifdef XINPUT_CALIBRATION_EEPROM
+	if (eepromAddress < 0) return false;  // Not saved
+
+	XInputCalibrationRecord record;
+	EEPROM.get(eepromAddress, record);
+	if (record.magic != XInputCalibrationRecord::Magic || record.checksum != calibrationChecksum(record)) {
+		return false;  // Blank or corrupt
+	}
+
+	deadband = record.deadband;
+	validMask = 0;
+	for (uint8_t a = 0; a < NumAxes; a++) {
+		points[a].min  = record.points[a][0];
+		points[a].rest = record.points[a][1];
+		points[a].max  = record.points[a][2];
+		if ((record.valid & (1 << a)) && build(points[a], deadband, a >= TriggerLeft, transforms[a])) {
+			validMask |= (1 << a);
+		}
+	}
+	return validMask != 0;
+#else
+	return false;
+#endif
+}
+
+void XInputCalibration::start(uint8_t restSamples) {
+	validMask = 0;  // Raw values pass through while learning
+	restTarget = restSamples > 0 ? restSamples : 1;
+	for (uint8_t a = 0; a < NumAxes; a++) {
+		points[a].min = INT32_MAX;
+		points[a].max = INT32_MIN;
+		restCount[a] = 0;
+		restSum[a] = 0;
+	}
+	learningMode = true;
+}
+
+uint8_t XInputCalibration::finish() {
+	if (!learningMode) return validMask;
+	learningMode = false;
+
+	validMask = 0;
+	for (uint8_t a = 0; a < NumAxes; a++) {
+		if (restCount[a] == 0) continue;  // Never sampled
+		points[a].rest = restSum[a] / restCount[a];
+		if (build(points[a], deadband, a >= TriggerLeft, transforms[a])) {
+			validMask |= (1 << a);
+		}
+	}
+	save();
+	return validMask;
+}
+
+void XInputCalibration::setDeadband(uint16_t permille) {
+	if (permille >= 1000) return;  // Error: Out of range
+	deadband = permille;
+
+	for (uint8_t a = 0; a < NumAxes; a++) {
+		if (!(validMask & (1 << a))) continue;
+		if (!build(points[a], deadband, a >= TriggerLeft, transforms[a])) validMask &= ~(1 << a);
+	}
+	// Not saved here: while learning the points are partial, and EEPROM
+	// writes block. finish() or save() from the loop keeps it.
+}
+
+boolean XInputCalibration::calibrated(uint8_t axis) const {
+	if (axis >= NumAxes) return false;
+	return validMask & (1 << axis);
+}
+
+boolean XInputCalibration::transform(uint8_t axis, int32_t & value) {
+	if (axis >= NumAxes) return false;  // Error: Not an axis
+
+	if (learningMode) {
+		if (restCount[axis] < restTarget) {
+			restSum[axis] += value;
+			restCount[axis]++;
+		}
+		if (value < points[axis].min) points[axis].min = value;
+		if (value > points[axis].max) points[axis].max = value;
+		return false;
+	}
+
+	if (!(validMask & (1 << axis))) return false;
+
+	const Transform & t = transforms[axis];
+	const uint8_t i = (value >= t.bounds[0]) + (value >= t.bounds[1]);
+	const Segment & s = t.segments[i];
+	const int32_t out = s.base + (int32_t) (((int64_t) (value - s.start) * s.gain) >> 16);
+	value = constrain(out, t.outMin, t.outMax);
+	return true;
+}
+
+// Q16 slope, rounded up so the ends of travel reach full scale before the clamp
+static int32_t gain(int32_t range, int32_t span) {
+	return (int32_t) ((((int64_t) range << 16) + span - 1) / span);
+}
+
+// Sticks: min to rest maps to -32768 to 0, rest to max maps to 0 to 32767.
+// Triggers: rest to the far end maps to 0 to 65535, either direction.
+boolean XInputCalibration::build(const Points & p, uint16_t deadband, boolean trigger, Transform & t) {
+	if (p.rest - p.min < MinSpan && p.max - p.rest < MinSpan) return false;  // Error: Axis didn't move
+	if (p.min >= p.max) return false;
+
+	t.segments[0] = t.segments[1] = t.segments[2] = Segment();
+
+	if (!trigger) {
+		if (p.rest - p.min < MinSpan || p.max - p.rest < MinSpan) return false;  // Error: One side didn't move
+
+		const int32_t lo = p.rest - (int32_t) (((int64_t) (p.rest - p.min) * deadband) / 1000);
+		const int32_t hi = p.rest + (int32_t) (((int64_t) (p.max - p.rest) * deadband) / 1000);
+
+		t.bounds[0] = lo;
+		t.bounds[1] = hi;
+		t.segments[0].start = lo;
+		t.segments[0].gain = gain(32768, lo - p.min);
+		t.segments[2].start = hi;
+		t.segments[2].gain = gain(32767, p.max - hi);
+		t.outMin = -32768;
+		t.outMax = 32767;
+		return true;
+	}
+
+	// Triggers rest at whichever end is closer
+	const boolean inverted = (p.max - p.rest) < (p.rest - p.min);
+	const int32_t travel = p.max - p.min;
+	const int32_t band = (int32_t) (((int64_t) travel * deadband) / 1000);
+	if (travel - band < 2) return false;  // Error: Deadband leaves no travel
+
+	if (!inverted) {
+		const int32_t lo = p.min + band;
+		t.bounds[0] = t.bounds[1] = lo;
+		t.segments[2].start = lo;
+		t.segments[2].gain = gain(65535, p.max - lo);
+	}
+	else {
+		const int32_t hi = p.max - band;
+		t.bounds[0] = t.bounds[1] = hi;
+		t.segments[0].start = hi;
+		t.segments[0].gain = -gain(65535, hi - p.min);
+	}
+	t.outMin = 0;
+	t.outMax = 65535;
+	return true;
+}
+
+void XInputCalibration::save() const {
+#ifdef XINPUT_CALIBRATION_EEPROM
+	if (eepromAddress < 0) return;
+	if (learningMode) return;  // Error: Points are partial, keep the saved record
+
+	XInputCalibrationRecord record;
+	memset(&record, 0x00, sizeof(record));
+	record.magic = XInputCalibrationRecord::Magic;
+	record.deadband = deadband;
+	record.valid = validMask;
+	for (uint8_t a = 0; a < NumAxes; a++) {
+		record.points[a][0] = points[a].min;
+		record.points[a][1] = points[a].rest;
+		record.points[a][2] = points[a].max;
+	}
+	record.checksum = calibrationChecksum(record);
+	EEPROM.put(eepromAddress, record);
+#endif
+}
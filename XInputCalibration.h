@@ -0,0 +1,119 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_CALIBRATION_H
+#define XINPUT_CALIBRATION_H
+
+#include "XInput.h"
+
+/*
+Per-axis calibration of the sticks and triggers. In learning mode the
+first samples of each axis are averaged as its rest point (sticks centered,
+triggers released), then the minimum and maximum are tracked while every
+axis is moved through its full travel. finish() turns each axis into a
+three-segment fixed-point transform with a deadband around the rest point
+and saves the points to EEPROM.
+
+  XInputCalibration calibration(16);  // Saved at EEPROM address 16
+  calibration.begin();  // Load the saved calibration
+  XInput.setCalibration(&calibration);
+
+  calibration.start();   // Leave the sticks alone for a moment, then sweep them
+  calibration.finish();  // Build, save, and use it
+
+  calibration.setDeadband(50);
+  calibration.save();  // Keep the new deadband
+
+Calibrated axes skip the controller's input range, and take raw readings
+directly. Uncalibrated axes still use setRange().
+*/
+
+class XInputCalibration {
+public:
+	enum Axis : uint8_t {
+		LeftX = 0,
+		LeftY = 1,
+		RightX = 2,
+		RightY = 3,
+		TriggerLeft = 4,
+		TriggerRight = 5,
+		NumAxes = 6,
+	};
+
+	static const int32_t MinSpan = 16;  // Raw units each side of the rest point must cover
+
+	XInputCalibration(int eepromAddress = -1);  // -1 doesn't save
+
+	boolean begin();  // Load from EEPROM, false if nothing valid is saved
+
+	void start(uint8_t restSamples = 32);  // Enter learning mode
+	uint8_t finish();  // Build and save, returns the calibrated axes (bitmask)
+	boolean learning() const { return learningMode; }
+
+	void setDeadband(uint16_t permille);  // Around the rest point, of each side's travel. Not saved until save().
+	boolean calibrated(uint8_t axis) const;
+
+	// Replaces 'value' with the calibrated output if the axis is calibrated.
+	// Also records the sample while learning.
+	boolean transform(uint8_t axis, int32_t & value);
+
+	void save() const;  // Write the points and deadband to EEPROM, from loop(). Skipped while learning.
+
+private:
+	struct Points {
+		int32_t min, rest, max;
+	};
+
+	// out = base + (in - start) * gain, with gain in Q16
+	struct Segment {
+		int32_t start;
+		int32_t base;
+		int32_t gain;
+	};
+
+	struct Transform {
+		int32_t bounds[2];  // Segment 0 below bounds[0], 2 at or above bounds[1]
+		Segment segments[3];
+		int32_t outMin, outMax;
+	};
+
+	Points points[NumAxes];
+	Transform transforms[NumAxes];
+	uint8_t validMask;
+	uint16_t deadband;  // Per-mille
+
+	const int eepromAddress;
+
+	// Learning
+	boolean learningMode;
+	uint8_t restTarget;
+	uint8_t restCount[NumAxes];
+	int32_t restSum[NumAxes];
+
+	static boolean build(const Points & p, uint16_t deadband, boolean trigger, Transform & t);
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputCombo.h"
+
+// --------------------------------------------------------
+// XInputComboEngine Class                                |
+// --------------------------------------------------------
+
+XInputComboEngine * XInputComboEngine::instance = nullptr;
+
+XInputComboEngine::XInputComboEngine(XInputController & c, const XInputCombo * table, uint8_t count) :
+	controller(c), combos(table), numCombos(count > MaxCombos ? MaxCombos : count),
+	matching(0), activeCombos(0), since(), actionCallback(nullptr)
+{}
+
+void XInputComboEngine::sendCallback(XInputController & c) {
+	if (instance != nullptr && &instance->controller == &c) instance->evaluate();
+}
+
+void XInputComboEngine::begin() {
+	instance = this;
+	controller.setSendCallback(sendCallback);
+}
+
+void XInputComboEngine::end() {
+	controller.setSendCallback(nullptr);
+	controller.setButtonRemap(0, 0);
+	if (instance == this) instance = nullptr;
+	matching = activeCombos = 0;
+}
+
+void XInputComboEngine::setActionCallback(ActionCallback cback) {
+	actionCallback = cback;
+}
+
+boolean XInputComboEngine::active(uint8_t combo) const {
+	if (combo >= numCombos) return false;  // Error: Not a combo
+	return activeCombos & (1 << combo);
+}
+
+void XInputComboEngine::evaluate() {
+	const uint16_t buttons = controller.getButtons();
+	const uint32_t frame = XInputController::frameCount();
+
+	uint16_t press = 0;
+	uint16_t release = 0;
+
+	for (uint8_t i = 0; i < numCombos; i++) {
+		const XInputCombo & combo = combos[i];
+		const uint16_t bit = 1 << i;
+
+		if ((buttons & combo.mask) != combo.state) {
+			matching &= ~bit;
+			activeCombos &= ~bit;
+			continue;
+		}
+
+		if (!(matching & bit)) {
+			matching |= bit;
+			since[i] = frame;
+		}
+
+		if (!(activeCombos & bit) && frame - since[i] >= combo.hold) {
+			activeCombos |= bit;
+			if (actionCallback != nullptr) actionCallback(i);
+		}
+
+		if (activeCombos & bit) {
+			press |= combo.press;
+			release |= combo.release;
+		}
+	}
+
+	controller.setButtonRemap(press, release & ~press);
+}
@@ -0,0 +1,91 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_COMBO_H
+#define XINPUT_COMBO_H
+
+#include "XInput.h"
+
+/*
+Matches button chords against the report-ordered button word, right before
+each report is sent. A combo is active while (buttons & mask) == state
+has held for 'hold' USB frames. While active it presses and releases
+buttons in the outgoing report through the controller's button remap,
+leaving the sketch's own button state alone.
+
+  const uint16_t StartBack = XInputController::getButtonMask(BUTTON_START) | XInputController::getButtonMask(BUTTON_BACK);
+  const XInputCombo combos[] = {
+    // mask, state, hold, press, release
+    { StartBack, StartBack, 0, XInputController::getButtonMask(BUTTON_LOGO), StartBack },  // Start + Back = Logo
+  };
+  XInputComboEngine comboEngine(XInput, combos, 1);
+
+Combos are checked on every send, so holds are only noticed as often as
+send() is called: every loop with auto-send off, or every frame with
+frame sync on.
+*/
+
+struct XInputCombo {
+	uint16_t mask;     // Buttons to check
+	uint16_t state;    // Required state of those buttons, 1 = pressed
+	uint16_t hold;     // USB frames (ms) the match must hold before firing
+	uint16_t press;    // Buttons added to the report while active
+	uint16_t release;  // Buttons removed from the report while active
+};
+
+class XInputComboEngine {
+public:
+	static const uint8_t MaxCombos = 16;
+
+	using ActionCallback = void(*)(uint8_t combo);  // Index of the combo that fired
+
+	XInputComboEngine(XInputController & controller, const XInputCombo * combos, uint8_t count);
+
+	void begin();  // Attach to the controller's send path
+	void end();
+
+	void setActionCallback(ActionCallback cback);  // Once per activation
+
+	boolean active(uint8_t combo) const;
+	uint16_t activeMask() const { return activeCombos; }
+
+	void evaluate();  // Match against the live buttons and set the remap
+
+private:
+	XInputController & controller;
+	const XInputCombo * const combos;
+	const uint8_t numCombos;
+
+	uint16_t matching;  // Combos whose state currently matches
+	uint16_t activeCombos;  // Combos that have fired and still match
+	uint32_t since[MaxCombos];  // Frame each match started
+	ActionCallback actionCallback;
+
+	static XInputComboEngine * instance;  // Engine run by the send callback
+	static void sendCallback(XInputController & controller);
+};
+
+#endif
@@ -0,0 +1,219 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputConfig.h"
+#include "XInputProfile.h"
+
+// --------------------------------------------------------
+// XInput Config Wire Format                              |
+// (Little-endian, independent of the MCU's layout)       |
+// --------------------------------------------------------
+
+static void configPut16(uint8_t * p, uint16_t v) {
+	p[0] = lowByte(v);
+	p[1] = highByte(v);
+}
+
+static void configPut32(uint8_t * p, uint32_t v) {
+	for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t) (v >> (i * 8));
+}
+
+static uint16_t configGet16(const uint8_t * p) {
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t configGet32(const uint8_t * p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+// Sizes of the Range and Shaping payloads
+static const uint8_t ConfigRangeSize = 8;
+static const uint8_t ConfigShapingSize = 7;
+
+// --------------------------------------------------------
+// XInputConfigChannel Class                              |
+// --------------------------------------------------------
+
+XInputConfigChannel * XInputConfigChannel::active = nullptr;
+
+XInputConfigChannel::XInputConfigChannel(XInputController & c, XInputProfileSet * p) :
+	controller(c), profiles(p),
+	pending(false), pendingCommand(0), pendingValue(0), pendingData(), pendingLength(0),
+	telemetry(), telemetrySize(0), telemetryRead(true)
+{}
+
+void XInputConfigChannel::begin() {
+	pending = false;
+	active = this;
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	XInputUSB::setConfigCallback(callback);
+#endif
+}
+
+void XInputConfigChannel::end() {
+	if (active != this) return;  // Not running
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	XInputUSB::setConfigCallback(nullptr);
+#endif
+	active = nullptr;
+}
+
+boolean XInputConfigChannel::service() {
+	if (telemetryRead) {
+		// Packed here in the loop, published with the interrupt held off
+		XInputTelemetryFrame frame;
+		controller.getTelemetry(frame);
+		uint8_t out[XInputTelemetry::FrameSize];
+		const uint8_t size = XInputTelemetry::encode(frame, out);
+
+		noInterrupts();
+		memcpy(telemetry, out, size);
+		telemetrySize = size;
+		telemetryRead = false;
+		interrupts();
+	}
+
+	if (!pending) return false;
+
+	const uint8_t * data = pendingData;
+	const XInputControl ctrl = (XInputControl) pendingValue;
+
+	switch (pendingCommand) {
+	case(Range):
+		controller.setRange(ctrl, (int32_t) configGet32(data), (int32_t) configGet32(data + 4));
+		break;
+	case(Shaping):
+		controller.setDeadzone(ctrl, configGet16(data), configGet16(data + 2));
+		controller.setAntiDeadzone(ctrl, configGet16(data + 4));
+		controller.setCurve(ctrl, (XInputCurve) data[6]);
+		break;
+	case(Profile):
+		if (profiles != nullptr) profiles->select(pendingValue);
+		break;
+	}
+
+	pending = false;  // Free for the next write
+	return true;
+}
+
+#ifdef XINPUT_CONFIG_SIMULATED
+int XInputConfigChannel::transfer(boolean in, uint16_t command, uint16_t value, uint8_t * buf, uint8_t len) {
+	if (active != this) return -1;  // Not started
+	return callback(in, command, value, buf, len);
+}
+#endif
+
+int XInputConfigChannel::callback(bool in, uint16_t command, uint16_t value, uint8_t * buf, uint8_t len) {
+	XInputConfigChannel * const self = active;
+	if (self == nullptr) return -1;  // Error: Not started
+
+	if (len > MaxData) len = MaxData;
+	return in ? self->read(command, value, buf, len) : self->queue(command, value, buf, len);
+}
+
+int XInputConfigChannel::read(uint16_t command, uint16_t value, uint8_t * buf, uint8_t len) {
+	uint8_t out[XInputTelemetry::FrameSize];
+	uint8_t size = 0;
+
+	switch (command) {
+	case(Info):
+		out[0] = Version;
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+		out[1] = XInputUSB::interfaces();
+#else
+		out[1] = XInputController::MaxControllers;
+#endif
+		out[2] = profiles != nullptr ? profiles->count() : 0;
+		out[3] = profiles != nullptr ? profiles->index() : 0;
+		size = 4;
+		break;
+	case(Range): {
+		int32_t rangeMin, rangeMax;
+		if (!controller.getRange((XInputControl) value, rangeMin, rangeMax)) return -1;  // Error: Not ranged
+		configPut32(out, (uint32_t) rangeMin);
+		configPut32(out + 4, (uint32_t) rangeMax);
+		size = ConfigRangeSize;
+		break;
+	}
+	case(Shaping): {
+		uint16_t inner, outer, anti;
+		XInputCurve curve;
+		if (!controller.getShaping((XInputControl) value, inner, outer, anti, curve)) return -1;  // Error: Not shapeable
+		configPut16(out, inner);
+		configPut16(out + 2, outer);
+		configPut16(out + 4, anti);
+		out[6] = (uint8_t) curve;
+		size = ConfigShapingSize;
+		break;
+	}
+	case(Profile):
+		if (profiles == nullptr) return -1;  // Error: No profiles
+		out[0] = profiles->index();
+		out[1] = profiles->count();
+		size = 2;
+		break;
+	case(Telemetry):
+		memcpy(out, telemetry, telemetrySize);  // From the last service(), not packed here
+		size = telemetrySize;
+		telemetryRead = true;
+		break;
+	default:
+		return -1;  // Error: Unknown command
+	}
+
+	if (size > len) size = len;  // Host asked for less
+	memcpy(buf, out, size);
+	return size;
+}
+
+int XInputConfigChannel::queue(uint16_t command, uint16_t value, const uint8_t * buf, uint8_t len) {
+	if (pending) return -1;  // Busy, the host retries
+
+	uint8_t size;
+	switch (command) {
+	case(Range):
+		size = ConfigRangeSize;
+		break;
+	case(Shaping):
+		size = ConfigShapingSize;
+		if (len >= size && buf[6] > (uint8_t) XInputCurve::Aggressive) return -1;  // Error: Unknown curve
+		break;
+	case(Profile):
+		if (profiles == nullptr || value >= profiles->count()) return -1;  // Error: No such profile
+		size = 0;
+		break;
+	default:
+		return -1;  // Error: Unknown or read-only command
+	}
+	if (len != size) return -1;  // Error: Wrong payload size
+
+	pendingCommand = command;
+	pendingValue = value;
+	memcpy(pendingData, buf, len);
+	pendingLength = len;
+	pending = true;
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_CONFIG_H
+#define XINPUT_CONFIG_H
+
+#include "XInput.h"
+#include "XInputTelemetry.h"
+
+class XInputProfileSet;
+
+/*
+Live configuration over vendor control requests on endpoint 0, so ranges,
+shaping and the profile can be tuned on site without reflashing. Requests
+use bRequest VENDOR_CODE (as the OS descriptor does) with the command in
+wIndex, and are answered from the USB interrupt. Reads are immediate,
+writes are queued and applied by service() from the loop, so they never
+land in the middle of an update. Telemetry is the exception: packing a
+report from the interrupt could catch the controls mid-change, so
+service() takes a snapshot and the read returns that. It's as old as the
+last service() before the request. See extras/xinput_config.py for the host.
+
+  XInputConfigChannel config(XInput, &profiles);
+  config.begin();
+  config.service();  // In loop()
+
+  Command         wIndex  wValue    Data (little-endian)
+  Info       IN   0x0100  -         version, interfaces, profile count, profile
+  Range      I/O  0x0101  control   int32 min, int32 max
+  Shaping    I/O  0x0102  control   uint16 inner, outer, anti (per-mille), uint8 curve
+  Profile    I/O  0x0103  index     IN: index, count. OUT: no data.
+  Telemetry  IN   0x0104  -         XInputTelemetry frame (36 bytes)
+
+A write that arrives before the last one was applied is stalled, and
+can be retried. Without the XInput USB interface (e.g. on the host),
+transfer() stands in for the control requests.
+*/
+
+#if !defined(USB_XINPUT) && !defined(XINPUT_INTERFACE)
+#define XINPUT_CONFIG_SIMULATED
+#endif
+
+class XInputConfigChannel {
+public:
+	enum Command : uint16_t {
+		Info = 0x0100,
+		Range = 0x0101,
+		Shaping = 0x0102,
+		Profile = 0x0103,
+		Telemetry = 0x0104,
+	};
+
+	static const uint8_t Version = 1;
+	static const uint8_t MaxData = 64;  // One EP0 packet
+
+	XInputConfigChannel(XInputController & controller, XInputProfileSet * profiles = nullptr);
+
+	void begin();
+	void end();
+	boolean service();  // Applies a queued write, true if there was one. Also refreshes telemetry.
+
+#ifdef XINPUT_CONFIG_SIMULATED
+	int transfer(boolean in, uint16_t command, uint16_t value, uint8_t * buf, uint8_t len);
+#endif
+
+private:
+	XInputController & controller;
+	XInputProfileSet * const profiles;
+
+	// Queued write, filled in the USB interrupt
+	volatile boolean pending;
+	uint16_t pendingCommand, pendingValue;
+	uint8_t pendingData[8];
+	uint8_t pendingLength;
+
+	// Telemetry snapshot, taken by service() and read in the USB interrupt
+	uint8_t telemetry[XInputTelemetry::FrameSize];
+	uint8_t telemetrySize;  // 0 until the first snapshot
+	volatile boolean telemetryRead;  // Taken by the host, refresh it
+
+	int read(uint16_t command, uint16_t value, uint8_t * buf, uint8_t len);
+	int queue(uint16_t command, uint16_t value, const uint8_t * buf, uint8_t len);
+
+	static XInputConfigChannel * active;  // Instance served by the USB callback
+	static int callback(bool in, uint16_t command, uint16_t value, uint8_t * buf, uint8_t len);
+};
+
+#endif
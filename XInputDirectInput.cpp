@@ -0,0 +1,140 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputDirectInput.h"
+
+// --------------------------------------------------------
+// XInputJoystickMirror Field Map                         |
+// --------------------------------------------------------
+
+// XInput button word bits (see XInput.cpp)
+enum : uint8_t {
+	Bit_Start = 4, Bit_Back = 5, Bit_L3 = 6, Bit_R3 = 7,
+	Bit_LB = 8, Bit_RB = 9, Bit_Logo = 10,
+	Bit_A = 12, Bit_B = 13, Bit_X = 14, Bit_Y = 15,
+};
+
+#define MIRROR_BUTTONS \
+	{ Kind::Button, Bit_A,     0, 1 }, \
+	{ Kind::Button, Bit_B,     1, 1 }, \
+	{ Kind::Button, Bit_X,     2, 1 }, \
+	{ Kind::Button, Bit_Y,     3, 1 }, \
+	{ Kind::Button, Bit_LB,    4, 1 }, \
+	{ Kind::Button, Bit_RB,    5, 1 }, \
+	{ Kind::Button, Bit_Back,  6, 1 }, \
+	{ Kind::Button, Bit_Start, 7, 1 }, \
+	{ Kind::Button, Bit_L3,    8, 1 }, \
+	{ Kind::Button, Bit_R3,    9, 1 }, \
+	{ Kind::Button, Bit_Logo, 10, 1 }
+
+#if XINPUT_MIRROR_SIZE == 64
+// 128 buttons, 23 16-bit axes (X, Y, Z, Rx, Ry, Rz, 17 sliders), 4 hats
+const XInputJoystickMirror::Field XInputJoystickMirror::Map[] = {
+	MIRROR_BUTTONS,
+	{ Kind::Axis,     0, 128, 16 },  // X
+	{ Kind::AxisFlip, 1, 144, 16 },  // Y
+	{ Kind::Trigger,  0, 160, 16 },  // Z
+	{ Kind::Axis,     2, 176, 16 },  // Rx
+	{ Kind::AxisFlip, 3, 192, 16 },  // Ry
+	{ Kind::Trigger,  1, 208, 16 },  // Rz
+	{ Kind::Hat,      0, 496, 4 },
+	{ Kind::Null,     0, 500, 4 },
+	{ Kind::Null,     0, 504, 4 },
+	{ Kind::Null,     0, 508, 4 },
+};
+#else
+// 32 buttons, a hat, then 10-bit X, Y, Z, Rz and two sliders
+const XInputJoystickMirror::Field XInputJoystickMirror::Map[] = {
+	MIRROR_BUTTONS,
+	{ Kind::Hat,      0, 32, 4 },
+	{ Kind::Axis,     0, 36, 10 },  // X
+	{ Kind::AxisFlip, 1, 46, 10 },  // Y
+	{ Kind::Axis,     2, 56, 10 },  // Z
+	{ Kind::AxisFlip, 3, 66, 10 },  // Rz
+	{ Kind::Trigger,  0, 76, 10 },  // Slider
+	{ Kind::Trigger,  1, 86, 10 },  // Slider
+};
+#endif
+
+const uint8_t XInputJoystickMirror::MapSize = sizeof(Map) / sizeof(Map[0]);
+
+// Hat position (0 is up, clockwise in 45 degree steps, 15 centered)
+// for the d-pad bits: up 1, down 2, left 4, right 8. Opposites cancel.
+static const uint8_t HatTable[16] = {
+	15, 0, 4, 15, 6, 7, 5, 6, 2, 1, 3, 2, 15, 0, 4, 15,
+};
+
+// --------------------------------------------------------
+// XInputJoystickMirror Class                             |
+// --------------------------------------------------------
+
+XInputJoystickMirror::XInputJoystickMirror() {
+	memset(last, 0x00, sizeof(last));
+}
+
+void XInputJoystickMirror::translate(const uint8_t * xinput, uint8_t * report) const {
+	const uint16_t buttons = xinput[2] | (xinput[3] << 8);
+
+	memset(report, 0x00, Size);
+	for (uint8_t i = 0; i < MapSize; i++) {
+		const Field & f = Map[i];
+		uint32_t value;
+
+		switch (f.kind) {
+		case Kind::Button:
+			value = (buttons >> f.source) & 1;
+			break;
+		case Kind::Hat:
+			value = HatTable[buttons & 0x0F];
+			break;
+		case Kind::Axis:
+		case Kind::AxisFlip: {
+			// Offset binary, so the signed range maps onto 0 - full scale
+			uint16_t raw = (xinput[6 + f.source * 2] | (xinput[7 + f.source * 2] << 8)) ^ 0x8000;
+			if (f.kind == Kind::AxisFlip) raw = ~raw;
+			value = raw >> (16 - f.width);
+			break;
+		}
+		case Kind::Trigger:
+			value = (xinput[4 + f.source] * 257U) >> (16 - f.width);  // 255 is full scale
+			break;
+		default:
+			value = (1U << f.width) - 1;
+			break;
+		}
+
+		// Fields are packed LSB first and may straddle bytes
+		uint16_t bit = f.bit;
+		for (uint8_t left = f.width; left > 0;) {
+			const uint8_t shift = bit & 7;
+			const uint8_t n = (8 - shift) < left ? (8 - shift) : left;
+			report[bit >> 3] |= (value & ((1U << n) - 1)) << shift;
+			value >>= n;
+			bit += n;
+			left -= n;
+		}
+	}
+}
@@ -0,0 +1,100 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_DIRECTINPUT_H
+#define XINPUT_DIRECTINPUT_H
+
+#include "XInput.h"
+
+/*
+DirectInput mirror for the "XInput + DI Joystick" USB type. The controller
+translates each changed XInput report into the joystick report and sends
+both as a pair, so the two interfaces can't drift apart and the sketch only
+drives XInput. Profiles, overlays and remaps are applied before the copy.
+
+  XInputJoystickMirror mirror;
+  XInput.setMirror(&mirror);
+
+The translation walks a fixed field map, chosen by JOYSTICK_SIZE:
+
+  XInput          12-byte joystick    64-byte joystick
+  A B X Y         Buttons 1-4         Buttons 1-4
+  LB RB           Buttons 5-6         Buttons 5-6
+  Back Start      Buttons 7-8         Buttons 7-8
+  L3 R3 Logo      Buttons 9-11        Buttons 9-11
+  D-pad           Hat                 Hat 1 (2-4 centered)
+  Left stick      X, Y                X, Y
+  Right stick     Z, Rz               Rx, Ry
+  Triggers        Sliders 1, 2        Z, Rz
+
+Stick Y axes are flipped, as HID has down positive. Don't use the Joystick
+object alongside the mirror, it sends on the same endpoint. Without the
+joystick interface (e.g. on the host) the 12-byte report is built and kept,
+but only the XInput report is sent.
+*/
+
+#if !defined(XINPUT_MIRROR_SIZE)
+#define XINPUT_MIRROR_SIZE 12
+#define XINPUT_MIRROR_SIMULATED
+#endif
+
+class XInputJoystickMirror {
+public:
+	static const uint8_t Size = XINPUT_MIRROR_SIZE;  // Joystick report bytes
+
+	XInputJoystickMirror();
+
+	// 20-byte XInput report in, joystick report out
+	void translate(const uint8_t * xinput, uint8_t * report) const;
+
+	const uint8_t * getReport() const { return last; }  // Last sent
+
+private:
+	enum class Kind : uint8_t {
+		Button,   // One bit of the XInput button word
+		Hat,      // From the d-pad bits
+		Axis,     // Stick, signed 16-bit
+		AxisFlip, // Stick, inverted
+		Trigger,  // 8-bit, stretched to the field
+		Null,     // Constant all-ones (centered hat)
+	};
+
+	struct Field {
+		Kind kind;
+		uint8_t source;  // Button bit, stick (left X, Y, right X, Y) or trigger
+		uint16_t bit;    // First bit in the joystick report, LSB first
+		uint8_t width;
+	};
+
+	static const Field Map[];
+	static const uint8_t MapSize;
+
+	uint8_t last[Size];
+
+	friend class XInputController;  // Updates 'last' once the pair is sent
+};
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputEdges.h"
+
+// --------------------------------------------------------
+// XInputEdgeCapture Class                                |
+// --------------------------------------------------------
+
+XInputEdgeCapture * XInputEdgeCapture::active = nullptr;
+
+XInputEdgeCapture::XInputEdgeCapture(const XInputPortScanner & s) :
+	scanner(s), ring(), head(0), tail(0),
+	lastButtons(0), unsent(0), overflowCount(0),
+	latencyLast(0), latencyPeak(0)
+{}
+
+void XInputEdgeCapture::isr() {
+	if (active != nullptr) active->onEdge();
+}
+
+boolean XInputEdgeCapture::attach(uint8_t pin) {
+#ifdef XINPUT_PORTS_SIMULATED
+	(void) pin;
+	return false;  // No pin interrupts
+#else
+	const int irq = digitalPinToInterrupt(pin);
+	if (irq < 0) return false;  // Error: Pin has no interrupt
+
+#if defined(ARM_DWT_CYCCNT)
+	// Start the cycle counter for timestamps
+	ARM_DEMCR |= ARM_DEMCR_TRCENA;
+	ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+
+	lastButtons = scanner.scan();
+	active = this;
+	attachInterrupt(irq, isr, CHANGE);
+	return true;
+#endif
+}
+
+void XInputEdgeCapture::onEdge() {
+	capture(now());
+}
+
+#ifdef XINPUT_PORTS_SIMULATED
+void XInputEdgeCapture::inject(uint32_t time) {
+	capture(time);
+}
+#endif
+
+void XInputEdgeCapture::capture(uint32_t time) {
+	const uint16_t buttons = scanner.scan();
+	if (buttons == lastButtons) return;  // Bounce or unmapped pin
+	lastButtons = buttons;
+
+	const uint8_t h = head;
+	const uint8_t next = (h + 1) & (RingSize - 1);
+	if (next == tail) {
+		// Full, fold into the newest edge so the final state is still right
+		ring[(h - 1) & (RingSize - 1)].buttons = buttons;
+		overflowCount++;
+		return;
+	}
+	ring[h].time = time;
+	ring[h].buttons = buttons;
+	head = next;
+}
+
+uint8_t XInputEdgeCapture::pending() const {
+	return (head - tail) & (RingSize - 1);
+}
+
+uint8_t XInputEdgeCapture::service(XInputController & controller) {
+	const uint16_t mask = scanner.mask();
+	uint8_t count = 0;
+
+	while (tail != head) {
+		// A full ring folds new edges into the newest slot, so copy it
+		// with the pin interrupt held off
+		noInterrupts();
+		const Edge edge = ring[tail];
+		interrupts();
+
+		if (count == 0) {
+			latencyLast = now() - edge.time;
+			if (latencyLast > latencyPeak) latencyPeak = latencyLast;
+		}
+
+		// Send a tap before the release that would hide it
+		if (unsent & ~edge.buttons) {
+			controller.flush();
+			if (controller.sendPending()) break;  // Not queued yet, keep the release for next time
+			unsent = 0;
+		}
+		unsent |= edge.buttons & ~controller.getButtons() & mask;
+
+		controller.setButtons(edge.buttons, mask);
+		tail = (tail + 1) & (RingSize - 1);
+		count++;
+	}
+	return count;
+}
+
+uint32_t XInputEdgeCapture::now() {
+#if defined(ARM_DWT_CYCCNT)
+	return ARM_DWT_CYCCNT;
+#else
+	return micros();
+#endif
+}
+
+uint32_t XInputEdgeCapture::ticksToMicros(uint32_t ticks) {
+#if defined(ARM_DWT_CYCCNT)
+	return ticks / (F_CPU / 1000000);
+#else
+	return ticks;
+#endif
+}
@@ -0,0 +1,99 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_EDGES_H
+#define XINPUT_EDGES_H
+
+#include "XInputPorts.h"
+
+/*
+Latches button changes from pin interrupts, so a press is seen when it
+happens rather than on the next pass of a polling loop. Every pin with a
+button is attached (CHANGE) to a shared handler, which rescans the ports
+and queues the new button word with a timestamp. service() merges the
+queued edges into the controller in order, sending between edges where a
+short tap would otherwise be lost. With frame sync on, that send goes
+through flush(); if the press can't be queued yet, the release waits in
+the ring until a later service().
+
+  XInputPortScanner scanner(tables);  // See XInputPorts.h
+  XInputEdgeCapture edges(scanner);
+
+  edges.attach(2);  // Each Arduino pin in the map, in setup()
+  edges.service(XInput);  // In loop()
+
+Timestamps are CPU cycles where the DWT cycle counter exists (Teensy 3.x),
+otherwise microseconds. On the host, inject() stands in for the interrupt.
+*/
+
+class XInputEdgeCapture {
+public:
+	static const uint8_t RingSize = 16;  // Power of two
+
+	XInputEdgeCapture(const XInputPortScanner & scanner);
+
+	boolean attach(uint8_t pin);  // Edge interrupt on an Arduino pin, false if unavailable
+	void onEdge();  // Interrupt handler body, for custom port ISRs
+
+#ifdef XINPUT_PORTS_SIMULATED
+	void inject(uint32_t time);  // Edge at 'time' ticks, from the simulated ports
+#endif
+
+	uint8_t service(XInputController & controller);  // Merge queued edges, returns count
+
+	uint8_t pending() const;
+	uint32_t overflows() const { return overflowCount; }
+
+	// Edge-to-merge latency of the oldest edge per service(), in ticks
+	uint32_t latency() const { return latencyLast; }
+	uint32_t latencyMax() const { return latencyPeak; }
+
+	static uint32_t now();  // Current time, in ticks
+	static uint32_t ticksToMicros(uint32_t ticks);
+
+private:
+	struct Edge {
+		uint32_t time;
+		uint16_t buttons;
+	};
+
+	const XInputPortScanner & scanner;
+
+	Edge ring[RingSize];
+	volatile uint8_t head, tail;  // Write (ISR), read (service)
+	uint16_t lastButtons;  // Last state queued
+	uint16_t unsent;  // Pressed by service() and not yet sent
+	uint32_t overflowCount;
+
+	uint32_t latencyLast, latencyPeak;
+
+	void capture(uint32_t time);
+
+	static XInputEdgeCapture * active;  // Instance served by the interrupt
+	static void isr();
+};
+
+#endif
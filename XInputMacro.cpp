@@ -0,0 +1,148 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputMacro.h"
+
+// --------------------------------------------------------
+// XInputMacroEngine Class                                |
+// --------------------------------------------------------
+
+XInputMacroEngine * XInputMacroEngine::active = nullptr;
+
+XInputMacroEngine::XInputMacroEngine(XInputController & c) :
+	controller(c), overlay(),
+	turboMask(0), turboOn(), turboOff(), turboPhase(),
+	macro(nullptr), macroAnalog(nullptr),
+	macroCount(0), macroStep(0), macroFrame(0), macroRepeat(false)
+{}
+
+void XInputMacroEngine::frameCallback() {
+	if (active != nullptr) active->tick();
+}
+
+void XInputMacroEngine::begin() {
+	active = this;
+	controller.setOverlay(&overlay);
+	controller.setFrameSync(true);
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	XInputUSB::setSOFCallback(frameCallback);
+#endif
+}
+
+void XInputMacroEngine::end() {
+#if defined(USB_XINPUT) || defined(XINPUT_INTERFACE)
+	XInputUSB::setSOFCallback(nullptr);
+#endif
+	if (active == this) active = nullptr;
+	controller.setFrameSync(false);
+	controller.setOverlay(nullptr);
+	controller.send();  // Without the overlay
+}
+
+void XInputMacroEngine::setTurbo(uint8_t button, uint8_t on, uint8_t off) {
+	const uint16_t mask = XInputController::getButtonMask(button);
+	if (mask == 0 || on == 0) return;  // Error: Not a button, or never pressed
+
+	uint8_t bit = 0;
+	while (!(mask & (1 << bit))) bit++;
+
+	noInterrupts();  // Read by the frame tick
+	turboOn[bit] = on;
+	turboOff[bit] = off;
+	turboPhase[bit] = 0;
+	turboMask |= mask;
+	interrupts();
+}
+
+void XInputMacroEngine::clearTurbo(uint8_t button) {
+	turboMask &= ~XInputController::getButtonMask(button);
+}
+
+void XInputMacroEngine::play(const XInputMacroStep * steps, uint8_t count, const XInputController::Overlay * analog, boolean repeat) {
+	// The frame tick reads all of these, so change them together
+	noInterrupts();
+	macroAnalog = analog;
+	macroCount = count;
+	macroStep = 0;
+	macroFrame = 0;
+	macroRepeat = repeat;
+	macro = (steps != nullptr && count > 0) ? steps : nullptr;
+	interrupts();
+}
+
+void XInputMacroEngine::stop() {
+	macro = nullptr;
+}
+
+boolean XInputMacroEngine::playing() const {
+	return macro != nullptr;
+}
+
+void XInputMacroEngine::tick() {
+	XInputController::Overlay next = XInputController::Overlay();
+
+	// Turbo buttons are released during the 'off' part of each cycle
+	const uint16_t held = controller.getButtons() & turboMask;
+	for (uint8_t bit = 0; bit < NumButtons; bit++) {
+		if (!(turboMask & (1 << bit))) continue;
+		if (!(held & (1 << bit))) {
+			turboPhase[bit] = 0;  // Restart on the next press
+			continue;
+		}
+		if (turboPhase[bit] >= turboOn[bit]) next.release |= (1 << bit);
+		if (++turboPhase[bit] >= turboOn[bit] + turboOff[bit]) turboPhase[bit] = 0;
+	}
+
+	// Current macro step
+	const XInputMacroStep * const steps = macro;
+	if (steps != nullptr) {
+		const XInputMacroStep & step = steps[macroStep];
+		if (step.frames == 0) {
+			macro = nullptr;  // End marker
+		}
+		else {
+			next.press |= step.buttons;
+			next.release &= ~step.buttons;
+			if (step.analog != 0 && macroAnalog != nullptr) {
+				const XInputController::Overlay & a = macroAnalog[step.analog - 1];
+				next.analog = a.analog;
+				memcpy(next.triggers, a.triggers, sizeof(next.triggers));
+				memcpy(next.joysticks, a.joysticks, sizeof(next.joysticks));
+			}
+
+			if (++macroFrame >= step.frames) {
+				macroFrame = 0;
+				if (++macroStep >= macroCount) {
+					macroStep = 0;
+					if (!macroRepeat) macro = nullptr;
+				}
+			}
+		}
+	}
+
+	overlay = next;
+	controller.pushFrame();
+}
@@ -0,0 +1,106 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_MACRO_H
+#define XINPUT_MACRO_H
+
+#include "XInput.h"
+
+/*
+Turbo and macro playback, clocked by the USB frame (SOF) interrupt. Once
+started, the engine runs once per 1 ms frame: it builds an overlay from
+the active turbo buttons and macro step, and pushes the report with that
+overlay applied. The main loop only sets the live controls; send() is
+handled by the frame tick, so delay() in the loop doesn't stall a macro.
+
+Macros are run-length sequences of steps. Each step holds a button
+pattern (report-ordered, see XInputController::getButtonMask()) for a
+number of frames, and can replace analog values with an entry from an
+overlay table:
+
+  const XInputController::Overlay moves[] = {
+    { 0, 0, XInputController::Overlay::JoyLeft, { 0, 0 }, { 0, -32768, 0, 0 } },  // Down
+  };
+  const XInputMacroStep hadouken[] = {
+    { 0, 16, 1 },                                         // Down for 16 ms
+    { XInputController::getButtonMask(BUTTON_X), 16, 0 },  // X
+  };
+
+  engine.play(hadouken, 2, moves);
+
+Without USB (host builds), call tick() to advance one frame.
+*/
+
+struct XInputMacroStep {
+	uint16_t buttons;  // Pressed for the step, report-ordered
+	uint8_t frames;    // Step length in USB frames (ms), 0 ends the macro
+	uint8_t analog;    // 1-based index into the overlay table, 0 for none
+};
+
+class XInputMacroEngine {
+public:
+	XInputMacroEngine(XInputController & controller);
+
+	void begin();  // Attach to the USB frame tick
+	void end();
+
+	// Turbo: while held, the button repeats 'on' frames pressed, 'off' released.
+	// Starts pressed, so the first frame isn't delayed.
+	void setTurbo(uint8_t button, uint8_t on = 33, uint8_t off = 33);
+	void clearTurbo(uint8_t button);
+
+	// Macros: overlaid on the live controls, one step at a time
+	void play(const XInputMacroStep * steps, uint8_t count, const XInputController::Overlay * analog = nullptr, boolean repeat = false);
+	void stop();
+	boolean playing() const;
+
+	void tick();  // Advance one frame and push the report
+
+private:
+	static const uint8_t NumButtons = 16;  // Bits in the button word
+
+	XInputController & controller;
+	XInputController::Overlay overlay;  // Rebuilt every frame
+
+	// Turbo, by button bit
+	uint16_t turboMask;
+	uint8_t turboOn[NumButtons];
+	uint8_t turboOff[NumButtons];
+	uint8_t turboPhase[NumButtons];  // Frames since the press, within the cycle
+
+	// Macro playback
+	const XInputMacroStep * volatile macro;
+	const XInputController::Overlay * macroAnalog;
+	uint8_t macroCount;
+	uint8_t macroStep;
+	uint8_t macroFrame;  // Frames into the current step
+	boolean macroRepeat;
+
+	static XInputMacroEngine * active;  // Instance run by the frame tick
+	static void frameCallback();
+};
+
+#endif
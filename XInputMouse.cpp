@@ -0,0 +1,87 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputMouse.h"
+
+// --------------------------------------------------------
+// XInputStickMouse Class                                 |
+// --------------------------------------------------------
+
+XInputStickMouse * XInputStickMouse::active = nullptr;
+
+XInputStickMouse::XInputStickMouse(XInputController & c, XInputControl s) :
+	controller(c), stick(s), curve(XInputCurve::Linear), gain(0), vx(0), vy(0)
+{
+	setSpeed(DefaultSpeed);
+}
+
+void XInputStickMouse::setSpeed(uint16_t countsPerSecond) {
+	// Counts per second to 1/256 counts per 1 ms frame, per unit of
+	// stick (32767), in Q16. Rounded up so full deflection reaches it.
+	const uint32_t den = 1000UL * 32767;
+	gain = (((uint64_t) countsPerSecond << 24) + den - 1) / den;
+}
+
+void XInputStickMouse::setCurve(XInputCurve c) {
+	curve = c;
+}
+
+void XInputStickMouse::begin() {
+	active = this;
+#ifndef XINPUT_MOUSE_SIMULATED
+	usb_mouse_hires_class::setFrameCallback(frameCallback);
+#endif
+}
+
+void XInputStickMouse::end() {
+	if (active != this) return;  // Not running
+#ifndef XINPUT_MOUSE_SIMULATED
+	usb_mouse_hires_class::setFrameCallback(nullptr);
+	usb_mouse_hires_velocity(0, 0);
+#endif
+	active = nullptr;
+	vx = vy = 0;
+}
+
+void XInputStickMouse::frameCallback() {
+	if (active != nullptr) active->frame();
+}
+
+void XInputStickMouse::frame() {
+	vx = convert(controller.getJoystickX(stick));
+	vy = -convert(controller.getJoystickY(stick));  // Stick up is mouse up (negative)
+#ifndef XINPUT_MOUSE_SIMULATED
+	usb_mouse_hires_velocity(vx, vy);
+#endif
+}
+
+int32_t XInputStickMouse::convert(int16_t axis) const {
+	uint32_t s = axis < 0 ? -(int32_t) axis : axis;
+	if (s > 32767) s = 32767;  // -32768
+	s = XInputShapeTable::curve(curve, s);
+	const int32_t v = (int32_t) ((s * (uint32_t) gain) >> 16);
+	return axis < 0 ? -v : v;
+}
@@ -0,0 +1,83 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_MOUSE_H
+#define XINPUT_MOUSE_H
+
+#include "XInput.h"
+
+/*
+Stick-driven mouse for the XInput + Keyboard + Mouse type, with MOUSE_HIRES
+set in usb_desc.h (trackball emulation). On every USB frame the stick is
+converted to a velocity, in 1/256 counts per frame, which the core adds
+up and sends as 16-bit deltas. Fractions of a count carry over to the
+next frame, so slow motion isn't lost and fast flicks aren't clamped.
+
+  XInputStickMouse stickMouse(XInput, JOY_RIGHT);
+  stickMouse.setSpeed(3000);  // Counts per second at full deflection
+  stickMouse.begin();
+
+The stick is read as the controller holds it, so its deadzone and
+curve settings apply. setCurve() adds a curve for the mouse on top.
+Without the high resolution mouse (e.g. on the host), frame() only
+computes the velocity.
+*/
+
+#if !defined(MOUSE_HIRES_INTERFACE)
+#define XINPUT_MOUSE_SIMULATED
+#endif
+
+class XInputStickMouse {
+public:
+	static const uint16_t DefaultSpeed = 2000;  // Counts per second
+
+	XInputStickMouse(XInputController & controller, XInputControl stick = JOY_RIGHT);
+
+	void setSpeed(uint16_t countsPerSecond);  // At full deflection
+	void setCurve(XInputCurve curve);
+
+	void begin();  // Converts on every USB frame from now on
+	void end();    // Stops, and stops the motion
+
+	void frame();  // One conversion, normally run from the USB frame
+
+	int32_t velocityX() const { return vx; }  // 1/256 counts per frame
+	int32_t velocityY() const { return vy; }  // Positive is down
+
+private:
+	XInputController & controller;
+	const XInputControl stick;
+	XInputCurve curve;
+	int32_t gain;  // Stick (Q15) to velocity, Q16
+	volatile int32_t vx, vy;
+
+	int32_t convert(int16_t axis) const;
+
+	static XInputStickMouse * active;  // Instance run by the frame callback
+	static void frameCallback();
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputPorts.h"
+
+// --------------------------------------------------------
+// XInputPortScanner Class                                |
+// --------------------------------------------------------
+
+#ifdef XINPUT_PORTS_SIMULATED
+uint32_t XInputPortScanner::simulated[XInputPortScanner::NumPorts];
+
+void XInputPortScanner::simulate(XInputPort port, uint32_t value) {
+	if ((uint8_t) port >= NumPorts) return;  // Error: Not a port
+	simulated[(uint8_t) port] = value;
+}
+#endif
+
+XInputPortScanner::XInputPortScanner(const XInputPortTables & t) :
+	tables(t)
+{}
+
+uint16_t XInputPortScanner::scan() const {
+	// One read per port, so the scan is a single snapshot
+	uint32_t ports[NumPorts];
+	for (uint8_t p = 0; p < NumPorts; p++) {
+		if (tables.portsUsed & (1 << p)) ports[p] = readPort(p);
+	}
+
+	uint16_t buttons = 0;
+	for (uint8_t g = 0; g < tables.numGroups; g++) {
+		const XInputPortTables::Group & group = tables.groups[g];
+		const uint8_t nibble = ((ports[group.port] >> group.shift) ^ group.invert) & 0x0F;
+		buttons |= group.table[nibble];
+	}
+	return buttons;
+}
+
+void XInputPortScanner::update(XInputController & controller) const {
+	controller.setButtons(scan(), tables.buttonMask);
+}
+
+uint32_t XInputPortScanner::readPort(uint8_t port) {
+#ifdef XINPUT_PORTS_SIMULATED
+	return simulated[port];
+#else
+	switch (port) {
+	case(0): return GPIOA_PDIR;
+	case(1): return GPIOB_PDIR;
+	case(2): return GPIOC_PDIR;
+	case(3): return GPIOD_PDIR;
+	case(4): return GPIOE_PDIR;
+	default: return 0;
+	}
+#endif
+}
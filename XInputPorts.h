@@ -0,0 +1,211 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_PORTS_H
+#define XINPUT_PORTS_H
+
+#include "XInput.h"
+#include "XInputProfile.h"
+
+/*
+Reads buttons straight from the GPIO port data input registers (GPIOx_PDIR)
+instead of calling digitalRead() per pin. Each scan reads every port in the
+map once, then gathers the bits into the button word with 16-entry lookup
+tables, one per port nibble that has a button on it. The tables are built
+by the compiler from a constexpr pin map, and live in flash.
+
+Pins are given by Kinetis port and bit. The Teensy core lists these in
+core_pins.h as CORE_PINn_BIT, e.g. pin 2 is port D bit 0 on Teensy 3.x:
+
+  constexpr XInputPin pins[] = {
+    { XInputPort::D, 0, BUTTON_A },
+    { XInputPort::A, 12, DPAD_UP },
+  };
+  constexpr XInputPortTables tables = XINPUT_PORT_TABLES(pins);
+  static_assert(XInputPortTables::check(pins), "Pin map doesn't fit the scanner");
+  XInputPortScanner scanner(tables);
+
+  scanner.update(XInput);  // In loop()
+
+A pin that isn't a button or d-pad, or isn't on a port, is left out, as
+are pins past the first MaxGroups nibbles. check() catches either at
+compile time, valid() at runtime.
+
+Pins must be set up with pinMode() first. Without the GPIO registers (e.g.
+on the host), the scanner reads from simulated ports set with simulate().
+*/
+
+#if !defined(GPIOA_PDIR)
+#define XINPUT_PORTS_SIMULATED
+#endif
+
+enum class XInputPort : uint8_t {
+	A = 0,
+	B = 1,
+	C = 2,
+	D = 3,
+	E = 4,
+};
+
+struct XInputPin {
+	constexpr XInputPin(XInputPort p, uint8_t b, XInputControl c, boolean high = false)
+		: port(p), bit(b), control(c), activeHigh(high) {}
+
+	XInputPort port;
+	uint8_t bit;  // 0-31
+	XInputControl control;  // Buttons and dpad only
+	boolean activeHigh;  // Pressed reads 1. Left out, pins are active-low (INPUT_PULLUP).
+};
+
+// Nibble lookup tables for XInputPortScanner, see XINPUT_PORT_TABLES()
+struct XInputPortTables {
+	static const uint8_t NumPorts = 5;
+	static const uint8_t MaxGroups = 8;  // Port nibbles with buttons on them
+
+	struct Group {
+		uint8_t port;
+		uint8_t shift;  // Nibble offset in the port
+		uint8_t invert;  // Active-low bits in the nibble
+		uint16_t table[16];  // Nibble value to button bits
+	};
+
+	Group groups[MaxGroups];
+	uint8_t numGroups;
+	uint8_t portsUsed;  // Bitmask of ports to read
+	uint16_t buttonMask;
+	bool valid;  // Every pin made it into the tables
+
+	// Compile-time helpers. Pins are grouped by nibble 'key' (port * 8 + nibble),
+	// in the order the nibbles first appear in the map.
+	static const uint8_t NoKey = 0xFF;
+
+	static constexpr bool usable(const XInputPin & p) {
+		return XInputProfile::mask(p.control) != 0 && p.bit <= 31 && (uint8_t) p.port < NumPorts;
+	}
+	static constexpr uint8_t key(const XInputPin & p) { return (uint8_t) p.port * 8 + p.bit / 4; }
+	static constexpr uint8_t bit(const XInputPin & p) { return 1 << (p.bit & 0x03); }
+
+	template<size_t N>
+	static constexpr bool seen(const XInputPin (&pins)[N], size_t i, size_t j = 0) {
+		return j >= i ? false :
+		       (usable(pins[j]) && key(pins[j]) == key(pins[i])) || seen(pins, i, j + 1);
+	}
+	template<size_t N>
+	static constexpr bool first(const XInputPin (&pins)[N], size_t i) {
+		return usable(pins[i]) && !seen(pins, i);
+	}
+	template<size_t N>
+	static constexpr uint8_t nibbles(const XInputPin (&pins)[N], size_t i = 0) {
+		return i >= N ? 0 : (first(pins, i) ? 1 : 0) + nibbles(pins, i + 1);
+	}
+	template<size_t N>
+	static constexpr uint8_t groupKey(const XInputPin (&pins)[N], uint8_t g, size_t i = 0) {
+		return i >= N || g >= MaxGroups ? NoKey :
+		       !first(pins, i) ? groupKey(pins, g, i + 1) :
+		       g == 0 ? key(pins[i]) : groupKey(pins, g - 1, i + 1);
+	}
+	template<size_t N>
+	static constexpr bool kept(const XInputPin (&pins)[N], size_t i, uint8_t g = 0) {
+		return g >= MaxGroups ? false :
+		       (usable(pins[i]) && groupKey(pins, g) == key(pins[i])) || kept(pins, i, g + 1);
+	}
+	template<size_t N>
+	static constexpr uint16_t entry(const XInputPin (&pins)[N], uint8_t k, uint8_t n, size_t i = 0) {
+		return i >= N ? 0 :
+		       ((usable(pins[i]) && key(pins[i]) == k && (n & bit(pins[i]))) ? XInputProfile::mask(pins[i].control) : 0) |
+		       entry(pins, k, n, i + 1);
+	}
+	template<size_t N>
+	static constexpr uint8_t invert(const XInputPin (&pins)[N], uint8_t k, size_t i = 0) {
+		return i >= N ? 0 :
+		       ((usable(pins[i]) && key(pins[i]) == k && !pins[i].activeHigh) ? bit(pins[i]) : 0) |
+		       invert(pins, k, i + 1);
+	}
+	template<size_t N>
+	static constexpr uint8_t ports(const XInputPin (&pins)[N], size_t i = 0) {
+		return i >= N ? 0 : (kept(pins, i) ? (1 << (uint8_t) pins[i].port) : 0) | ports(pins, i + 1);
+	}
+	template<size_t N>
+	static constexpr uint16_t buttons(const XInputPin (&pins)[N], size_t i = 0) {
+		return i >= N ? 0 : (kept(pins, i) ? XInputProfile::mask(pins[i].control) : 0) | buttons(pins, i + 1);
+	}
+	template<size_t N>
+	static constexpr bool check(const XInputPin (&pins)[N], size_t i = 0) {
+		return i >= N ? true : kept(pins, i) && check(pins, i + 1);
+	}
+
+	static constexpr uint8_t keyPort(uint8_t k) { return k == NoKey ? 0 : k / 8; }
+	static constexpr uint8_t keyShift(uint8_t k) { return k == NoKey ? 0 : (k % 8) * 4; }
+};
+
+// Tables for one nibble group
+#define XINPUT_PORT_GROUP(pins, g) { \
+	XInputPortTables::keyPort(XInputPortTables::groupKey(pins, g)), \
+	XInputPortTables::keyShift(XInputPortTables::groupKey(pins, g)), \
+	XInputPortTables::invert(pins, XInputPortTables::groupKey(pins, g)), { \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 0),  XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 1),  \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 2),  XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 3),  \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 4),  XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 5),  \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 6),  XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 7),  \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 8),  XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 9),  \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 10), XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 11), \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 12), XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 13), \
+	XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 14), XInputPortTables::entry(pins, XInputPortTables::groupKey(pins, g), 15) } }
+
+// XInputPortTables from a constexpr XInputPin array
+#define XINPUT_PORT_TABLES(pins) { { \
+	XINPUT_PORT_GROUP(pins, 0), XINPUT_PORT_GROUP(pins, 1), XINPUT_PORT_GROUP(pins, 2), XINPUT_PORT_GROUP(pins, 3), \
+	XINPUT_PORT_GROUP(pins, 4), XINPUT_PORT_GROUP(pins, 5), XINPUT_PORT_GROUP(pins, 6), XINPUT_PORT_GROUP(pins, 7) }, \
+	(uint8_t) (XInputPortTables::nibbles(pins) < XInputPortTables::MaxGroups ? XInputPortTables::nibbles(pins) : XInputPortTables::MaxGroups), \
+	XInputPortTables::ports(pins), XInputPortTables::buttons(pins), XInputPortTables::check(pins) }
+
+class XInputPortScanner {
+public:
+	static const uint8_t NumPorts = XInputPortTables::NumPorts;
+
+	XInputPortScanner(const XInputPortTables & tables);
+
+	uint16_t scan() const;  // Button word, as used by setButtons()
+	void update(XInputController & controller) const;
+
+	uint16_t mask() const { return tables.buttonMask; }  // Buttons in the map
+	boolean valid() const { return tables.valid; }  // false if pins were left out
+
+#ifdef XINPUT_PORTS_SIMULATED
+	static void simulate(XInputPort port, uint32_t value);
+#endif
+
+private:
+	const XInputPortTables & tables;
+
+	static uint32_t readPort(uint8_t port);
+
+#ifdef XINPUT_PORTS_SIMULATED
+	static uint32_t simulated[NumPorts];
+#endif
+};
+
+#endif
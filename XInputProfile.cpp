@@ -0,0 +1,80 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputProfile.h"
+
+#if defined(__has_include)
+#if __has_include(<EEPROM.h>)
+#include <EEPROM.h>
+#define XINPUT_PROFILE_EEPROM
+#endif
+#endif
+
+// --------------------------------------------------------
+// XInputProfileSet Class                                 |
+// --------------------------------------------------------
+
+XInputProfileSet::XInputProfileSet(XInputController & c, const XInputProfile * const * list, uint8_t count, int address) :
+	controller(c), profiles(list), numProfiles(count), eepromAddress(address), current(0), dirty(false)
+{}
+
+void XInputProfileSet::begin() {
+	uint8_t saved = 0;
+#ifdef XINPUT_PROFILE_EEPROM
+	if (eepromAddress >= 0) {
+		saved = EEPROM.read(eepromAddress);
+		if (saved >= numProfiles) saved = 0;  // Blank or stale EEPROM
+	}
+#endif
+	current = saved;
+	if (numProfiles > 0) controller.setProfile(profiles[current]);
+}
+
+boolean XInputProfileSet::select(uint8_t index) {
+	if (index >= numProfiles) return false;  // Error: Not a profile
+
+	controller.setProfile(profiles[index]);
+	current = index;
+	dirty = true;  // Written by save(), as EEPROM writes block
+	return true;
+}
+
+void XInputProfileSet::save() {
+	if (!dirty) return;
+	dirty = false;
+
+#ifdef XINPUT_PROFILE_EEPROM
+	const uint8_t index = current;
+	if (eepromAddress >= 0 && EEPROM.read(eepromAddress) != index) {
+		EEPROM.write(eepromAddress, index);  // Only on change, to spare the flash
+	}
+#endif
+}
+
+void XInputProfileSet::next() {
+	if (numProfiles == 0) return;
+	select((current + 1) % numProfiles);
+}
@@ -0,0 +1,159 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_PROFILE_H
+#define XINPUT_PROFILE_H
+
+#include "XInput.h"
+
+/*
+Mapping profiles: button remaps, axis inversions and response curves,
+built at compile time so they stay in flash. The controller follows a
+single profile pointer, so switching is one pointer swap and a build
+without a profile pays only for a null check.
+
+  constexpr XInputProfile::Remap swapAB[] = {
+    { BUTTON_A, XInputProfile::mask(BUTTON_B) },
+    { BUTTON_B, XInputProfile::mask(BUTTON_A) },
+    { BUTTON_BACK, XInputProfile::Drop },
+  };
+  const XInputShapeTable racing = XINPUT_TRIGGER_SHAPE(50, 950, 0, XInputCurve::Quadratic);
+
+  const XInputProfile fighting = { XINPUT_BUTTON_MAP(swapAB), 0, { nullptr, nullptr, nullptr, nullptr } };
+  const XInputProfile driving = { {}, XInputProfile::InvertLeftY, { &racing, &racing, nullptr, nullptr } };
+
+  const XInputProfile * const profiles[] = { nullptr, &fighting, &driving };
+  XInputProfileSet profileSet(XInput, profiles, 3, 0);  // Index saved at EEPROM address 0
+
+  profileSet.begin();  // In setup()
+  profileSet.save();  // In loop()
+
+Buttons are remapped as the report is packed, after combos and before
+turbo/macros. Analog inversions and curves apply as values are set, and
+only to the analog setJoystick(), not the digital one.
+
+select() and next() only switch the pointer, so they're safe from a combo
+callback in the USB interrupt. The EEPROM write, which blocks for
+milliseconds, is left for save() to make from loop().
+*/
+
+struct XInputProfile {
+	// Axis inversion flags
+	static const uint8_t InvertLeftX = 0x01;
+	static const uint8_t InvertLeftY = 0x02;
+	static const uint8_t InvertRightX = 0x04;
+	static const uint8_t InvertRightY = 0x08;
+	static const uint8_t InvertTriggerLeft = 0x10;
+	static const uint8_t InvertTriggerRight = 0x20;
+
+	static const uint16_t Drop = 0x0800;  // Unused report bit, cleared when packing
+
+	uint16_t buttons[16];  // Output buttons for each input button bit, report-ordered. 0 leaves it as-is.
+	uint8_t invert;  // Inversion flags
+	const XInputShapeTable * shapes[4];  // Trigger left, right, joystick left, right. nullptr uses the controller's own.
+
+	// Compile-time helpers, matching the button maps in XInput.cpp
+	struct Remap {
+		XInputControl from;
+		uint16_t to;  // Output buttons, from mask(), or Drop
+	};
+
+	static constexpr uint16_t mask(XInputControl ctrl) {
+		return ctrl == DPAD_UP      ? 0x0001 :
+		       ctrl == DPAD_DOWN    ? 0x0002 :
+		       ctrl == DPAD_LEFT    ? 0x0004 :
+		       ctrl == DPAD_RIGHT   ? 0x0008 :
+		       ctrl == BUTTON_START ? 0x0010 :
+		       ctrl == BUTTON_BACK  ? 0x0020 :
+		       ctrl == BUTTON_L3    ? 0x0040 :
+		       ctrl == BUTTON_R3    ? 0x0080 :
+		       ctrl == BUTTON_LB    ? 0x0100 :
+		       ctrl == BUTTON_RB    ? 0x0200 :
+		       ctrl == BUTTON_LOGO  ? 0x0400 :
+		       ctrl == BUTTON_A     ? 0x1000 :
+		       ctrl == BUTTON_B     ? 0x2000 :
+		       ctrl == BUTTON_X     ? 0x4000 :
+		       ctrl == BUTTON_Y     ? 0x8000 :
+		       0;
+	}
+
+	template<size_t N>
+	static constexpr uint16_t lookup(const Remap (&remaps)[N], uint8_t bit, size_t i = 0) {
+		return i >= N ? 0 :
+		       mask(remaps[i].from) == (1 << bit) ? remaps[i].to :
+		       lookup(remaps, bit, i + 1);
+	}
+};
+
+// Button table for XInputProfile::buttons, from a constexpr Remap array
+#define XINPUT_BUTTON_MAP(remaps) { \
+	XInputProfile::lookup(remaps, 0),  XInputProfile::lookup(remaps, 1),  XInputProfile::lookup(remaps, 2),  XInputProfile::lookup(remaps, 3),  \
+	XInputProfile::lookup(remaps, 4),  XInputProfile::lookup(remaps, 5),  XInputProfile::lookup(remaps, 6),  XInputProfile::lookup(remaps, 7),  \
+	XInputProfile::lookup(remaps, 8),  XInputProfile::lookup(remaps, 9),  XInputProfile::lookup(remaps, 10), XInputProfile::lookup(remaps, 11), \
+	XInputProfile::lookup(remaps, 12), XInputProfile::lookup(remaps, 13), XInputProfile::lookup(remaps, 14), XInputProfile::lookup(remaps, 15) }
+
+// Shape tables, with deadzones and anti-deadzone in per-mille (see setDeadzone())
+#define XINPUT_SHAPE_ENTRIES_8(b, inner, outer, anti, curve, radial) \
+	XInputShapeTable::entry(b + 0, inner, outer, anti, curve, radial), XInputShapeTable::entry(b + 1, inner, outer, anti, curve, radial), \
+	XInputShapeTable::entry(b + 2, inner, outer, anti, curve, radial), XInputShapeTable::entry(b + 3, inner, outer, anti, curve, radial), \
+	XInputShapeTable::entry(b + 4, inner, outer, anti, curve, radial), XInputShapeTable::entry(b + 5, inner, outer, anti, curve, radial), \
+	XInputShapeTable::entry(b + 6, inner, outer, anti, curve, radial), XInputShapeTable::entry(b + 7, inner, outer, anti, curve, radial)
+
+#define XINPUT_SHAPE_TABLE(inner, outer, anti, curve, radial) { \
+	(uint16_t) XInputShapeTable::scale(inner, radial), { \
+	XINPUT_SHAPE_ENTRIES_8(0,  inner, outer, anti, curve, radial), XINPUT_SHAPE_ENTRIES_8(8,  inner, outer, anti, curve, radial), \
+	XINPUT_SHAPE_ENTRIES_8(16, inner, outer, anti, curve, radial), XINPUT_SHAPE_ENTRIES_8(24, inner, outer, anti, curve, radial), \
+	XINPUT_SHAPE_ENTRIES_8(32, inner, outer, anti, curve, radial), XINPUT_SHAPE_ENTRIES_8(40, inner, outer, anti, curve, radial), \
+	XINPUT_SHAPE_ENTRIES_8(48, inner, outer, anti, curve, radial), XINPUT_SHAPE_ENTRIES_8(56, inner, outer, anti, curve, radial), \
+	XInputShapeTable::entry(64, inner, outer, anti, curve, radial) } }
+
+#define XINPUT_JOYSTICK_SHAPE(inner, outer, anti, curve) XINPUT_SHAPE_TABLE(inner, outer, anti, curve, true)
+#define XINPUT_TRIGGER_SHAPE(inner, outer, anti, curve)  XINPUT_SHAPE_TABLE(inner, outer, anti, curve, false)
+
+// Selects between profiles at runtime, keeping the choice in EEPROM
+class XInputProfileSet {
+public:
+	// 'eepromAddress' of -1 doesn't save the selection
+	XInputProfileSet(XInputController & controller, const XInputProfile * const * profiles, uint8_t count, int eepromAddress = -1);
+
+	void begin();  // Restore the saved profile
+	boolean select(uint8_t index);
+	void next();  // Cycle to the next profile
+	void save();  // Write a changed selection to EEPROM, from loop()
+
+	uint8_t index() const { return current; }
+	uint8_t count() const { return numProfiles; }
+
+private:
+	XInputController & controller;
+	const XInputProfile * const * const profiles;
+	const uint8_t numProfiles;
+	const int eepromAddress;
+	volatile uint8_t current;
+	volatile boolean dirty;  // Selection changed, not yet saved
+};
+
+#endif
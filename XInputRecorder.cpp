@@ -0,0 +1,179 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputRecorder.h"
+
+#include <string.h>
+
+static const uint8_t DeltaInline = 15;  // Delta values below this fit in the header
+
+// Report bytes that never change, so never appear in a record: the message
+// type (0) and the unused tail (14-19). Byte 1, the size, only changes once.
+static const uint32_t FixedBytesMask = 0x00001 | 0xFC000;
+static const uint8_t ReportSizeByte = 0x14;
+
+// --------------------------------------------------------
+// XInputRecorder Class (Encoder)                         |
+// --------------------------------------------------------
+
+XInputRecorder::XInputRecorder(uint8_t * storage, size_t size) :
+	buffer(storage), bufferSize(size)
+{
+	reset();
+}
+
+void XInputRecorder::reset() {
+	head = tail = 0;
+	memset(last, 0x00, sizeof(last));
+	lastFrame = 0;
+	started = false;
+	recordCount = dropCount = 0;
+}
+
+bool XInputRecorder::record(const uint8_t * report, uint32_t frame) {
+	uint8_t rec[MaxRecordSize];
+	uint8_t len = 3;
+
+	// Changed byte mask and data
+	uint32_t mask = 0;
+	for (uint8_t i = 0; i < ReportSize; i++) {
+		if (report[i] != last[i]) {
+			mask |= (1UL << i);
+		}
+	}
+	if (mask == 0) return true;  // Nothing to record
+
+	// Frame delta, with varint extension
+	uint32_t delta = started ? frame - lastFrame : 0;
+	rec[0] = mask & 0xFF;
+	rec[1] = (mask >> 8) & 0xFF;
+	rec[2] = (mask >> 16) & 0x0F;
+	if (delta < DeltaInline) {
+		rec[2] |= delta << 4;
+	}
+	else {
+		rec[2] |= DeltaInline << 4;
+		delta -= DeltaInline;
+		do {
+			rec[len++] = (delta & 0x7F) | (delta > 0x7F ? 0x80 : 0x00);
+			delta >>= 7;
+		} while (delta != 0);
+	}
+
+	for (uint8_t i = 0; i < ReportSize; i++) {
+		if (mask & (1UL << i)) {
+			rec[len++] = report[i];
+		}
+	}
+
+	// Write to ring. One slot stays open to tell 'full' from 'empty'.
+	const size_t space = bufferSize - 1 - available();
+	if (len > space) {
+		dropCount++;  // Next record stays relative to the last one written
+		return false;
+	}
+
+	size_t h = head;
+	for (uint8_t i = 0; i < len; i++) {
+		buffer[h] = rec[i];
+		if (++h == bufferSize) h = 0;
+	}
+	head = h;
+
+	memcpy(last, report, ReportSize);
+	lastFrame = frame;
+	started = true;
+	recordCount++;
+	return true;
+}
+
+size_t XInputRecorder::available() const {
+	const size_t h = head;
+	const size_t t = tail;
+	return (h >= t) ? (h - t) : (bufferSize - t + h);
+}
+
+size_t XInputRecorder::read(uint8_t * out, size_t len) {
+	size_t count = 0;
+	size_t t = tail;
+	const size_t h = head;
+
+	while (count < len && t != h) {
+		out[count++] = buffer[t];
+		if (++t == bufferSize) t = 0;
+	}
+	tail = t;
+	return count;
+}
+
+// --------------------------------------------------------
+// XInputRecordDecoder Class                              |
+// --------------------------------------------------------
+
+void XInputRecordDecoder::reset() {
+	memset(state, 0x00, sizeof(state));
+	frameTotal = 0;
+}
+
+size_t XInputRecordDecoder::decode(const uint8_t * data, size_t len) {
+	if (len < 3) return 0;
+
+	const uint32_t mask = data[0] | ((uint32_t) data[1] << 8) | ((uint32_t)(data[2] & 0x0F) << 16);
+	uint32_t delta = data[2] >> 4;
+	size_t pos = 3;
+
+	// Records are only written for a change, and never for the fixed bytes
+	if (mask == 0 || (mask & FixedBytesMask)) return Malformed;
+
+	if (delta == DeltaInline) {
+		uint32_t ext = 0;
+		uint8_t shift = 0;
+		uint8_t b;
+		do {
+			if (pos >= len) return 0;  // Incomplete
+			b = data[pos++];
+			if (shift == 28 && (b & 0xF0)) return Malformed;  // Past 32 bits
+			ext |= (uint32_t)(b & 0x7F) << shift;
+			shift += 7;
+		} while (b & 0x80);
+		delta += ext;
+	}
+
+	size_t count = 0;
+	for (uint8_t i = 0; i < XInputRecorder::ReportSize; i++) {
+		if (mask & (1UL << i)) count++;
+	}
+	if (pos + count > len) return 0;  // Incomplete
+	if ((mask & 0x02) && data[pos] != ReportSizeByte) return Malformed;  // Byte 1 comes first, byte 0 can't be there
+
+	for (uint8_t i = 0; i < XInputRecorder::ReportSize; i++) {
+		if (mask & (1UL << i)) {
+			state[i] = data[pos++];
+		}
+	}
+	frameTotal += delta;
+	return pos;
+}
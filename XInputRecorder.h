@@ -0,0 +1,109 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_RECORDER_H
+#define XINPUT_RECORDER_H
+
+// No Arduino dependencies, so the decoder can also be built on the host
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+Record format, one record per changed report:
+
+  [mask 0-7] [mask 8-15] [mask 16-19 | delta << 4] [delta extension] [changed bytes]
+
+The 20-bit mask flags which report bytes differ from the previous record,
+and the changed bytes follow in index order. 'delta' is the number of USB
+frames (milliseconds) since the previous record. Values 0-14 fit in the
+mask byte; 15 means the remainder (delta - 15) follows as a little-endian
+base-128 varint. The first record is relative to an all-zero report.
+
+A button press costs 4 bytes, a full stick move 7 bytes.
+
+Capacity: a moving stick changes the report every 1 ms frame. That is
+6-7 KB/s for one stick and 9-11 KB/s for both (a full-range sweep vs. every
+byte changing, measured by extras/tests/test_recorder.cpp). A 200 KB ring
+in Teensy 3.6 RAM holds about 30 seconds of one stick in constant motion,
+or 20 with both. Buttons are far cheaper (20 presses and releases a second
+is 80 B/s), so the length of a session depends on how much the sticks move.
+For anything longer, drain the ring with read() while recording.
+*/
+
+class XInputRecorder {
+public:
+	static const uint8_t ReportSize = 20;
+	static const uint8_t MaxRecordSize = 3 + 5 + ReportSize;  // Header, varint, bytes
+
+	// Storage is used as a FIFO ring. Drain it with read() while recording
+	// (e.g. to Serial) or leave it to fill and dump it after the session.
+	XInputRecorder(uint8_t * storage, size_t size);
+
+	void reset();  // Empty the ring and restart the delta chain
+
+	bool record(const uint8_t * report, uint32_t frame);  // false if dropped
+
+	size_t available() const;  // Bytes waiting to be read
+	size_t read(uint8_t * out, size_t len);
+
+	uint32_t records() const { return recordCount; }
+	uint32_t dropped() const { return dropCount; }
+
+private:
+	uint8_t * const buffer;
+	const size_t bufferSize;
+	volatile size_t head, tail;  // Write, read
+
+	uint8_t last[ReportSize];  // Last report written to the ring
+	uint32_t lastFrame;
+	bool started;
+
+	uint32_t recordCount, dropCount;
+};
+
+class XInputRecordDecoder {
+public:
+	XInputRecordDecoder() { reset(); }
+
+	void reset();
+
+	static const size_t Malformed = (size_t) -1;
+
+	// Decodes one record from the front of 'data'. Returns the number of bytes
+	// consumed, 0 if 'data' doesn't hold a complete record yet (wait for more),
+	// or Malformed if it can't be a record (stop, the stream is corrupt). The
+	// state is left as it was on either.
+	size_t decode(const uint8_t * data, size_t len);
+
+	const uint8_t * report() const { return state; }
+	uint32_t frame() const { return frameTotal; }  // Frames since the first record
+
+private:
+	uint8_t state[XInputRecorder::ReportSize];
+	uint32_t frameTotal;
+};
+
+#endif
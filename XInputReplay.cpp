@@ -0,0 +1,139 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputReplay.h"
+
+// --------------------------------------------------------
+// Report Button Order                                    |
+// (Matches each report bit to its control)              |
+// --------------------------------------------------------
+
+static const uint8_t NoControl = 0xFF;
+
+static const uint8_t ReportButtons[2][8] = {
+	{ DPAD_UP, DPAD_DOWN, DPAD_LEFT, DPAD_RIGHT, BUTTON_START, BUTTON_BACK, BUTTON_L3, BUTTON_R3 },  // tx[2]
+	{ BUTTON_LB, BUTTON_RB, BUTTON_LOGO, NoControl, BUTTON_A, BUTTON_B, BUTTON_X, BUTTON_Y },        // tx[3]
+};
+
+// --------------------------------------------------------
+// XInputReplay Class                                     |
+// --------------------------------------------------------
+
+XInputReplay::XInputReplay(XInputController & controller, const uint8_t * stream, size_t len) :
+	pad(controller), data(stream), length(len), holdingAutoSend(false)
+{
+	rewind();
+}
+
+XInputReplay::~XInputReplay() {
+	releaseAutoSend();
+}
+
+void XInputReplay::rewind() {
+	position = 0;
+	corrupt = false;
+	decoder.reset();
+
+	// One send per record. The controller's setting comes back at the end.
+	if (!holdingAutoSend) {
+		savedAutoSend = pad.getAutoSend();
+		holdingAutoSend = true;
+	}
+	pad.setAutoSend(false);
+}
+
+void XInputReplay::releaseAutoSend() {
+	if (!holdingAutoSend) return;
+	pad.setAutoSend(savedAutoSend);
+	holdingAutoSend = false;
+}
+
+bool XInputReplay::step() {
+	if (done()) {
+		releaseAutoSend();
+		return false;
+	}
+
+	const size_t used = decoder.decode(data + position, length - position);
+	if (used == 0 || used == XInputRecordDecoder::Malformed) {
+		corrupt = (used != 0);  // Otherwise truncated, the last record was cut off
+		position = length;
+		releaseAutoSend();
+		return false;
+	}
+	position += used;
+
+	const uint8_t * report = decoder.report();
+
+	const uint8_t dpad = report[2];
+	pad.setDpad(dpad & 0x01, dpad & 0x02, dpad & 0x04, dpad & 0x08);
+
+	for (uint8_t i = 0; i < 2; i++) {
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			const uint8_t ctrl = ReportButtons[i][bit];
+			if (ctrl == NoControl || (i == 0 && bit < 4)) continue;  // Unused, or d-pad
+			pad.setButton(ctrl, report[2 + i] & (1 << bit));
+		}
+	}
+
+	pad.setTrigger(TRIGGER_LEFT, report[4]);
+	pad.setTrigger(TRIGGER_RIGHT, report[5]);
+
+	pad.setJoystick(JOY_LEFT,
+		(int16_t)(report[6] | (report[7] << 8)),
+		(int16_t)(report[8] | (report[9] << 8)));
+	pad.setJoystick(JOY_RIGHT,
+		(int16_t)(report[10] | (report[11] << 8)),
+		(int16_t)(report[12] | (report[13] << 8)));
+
+	pad.send();
+	if (done()) releaseAutoSend();  // That was the last record
+	return true;
+}
+
+uint32_t XInputReplay::run() {
+	uint32_t count = 0;
+	while (step()) count++;
+	return count;
+}
+
+int32_t XInputReplay::compare(const uint8_t * a, size_t aLen, const uint8_t * b, size_t bLen) {
+	XInputRecordDecoder decA, decB;
+	size_t posA = 0, posB = 0;
+
+	for (int32_t index = 0; ; index++) {
+		const size_t usedA = decA.decode(a + posA, aLen - posA);
+		const size_t usedB = decB.decode(b + posB, bLen - posB);
+
+		if (usedA == XInputRecordDecoder::Malformed || usedB == XInputRecordDecoder::Malformed) return index;
+		if (usedA == 0 && usedB == 0) return -1;  // Both ended, all matched
+		if (usedA == 0 || usedB == 0) return index;  // One is longer
+		if (memcmp(decA.report(), decB.report(), XInputRecorder::ReportSize) != 0) return index;
+
+		posA += usedA;
+		posB += usedB;
+	}
+}
@@ -0,0 +1,79 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_REPLAY_H
+#define XINPUT_REPLAY_H
+
+#include "XInput.h"
+#include "XInputRecorder.h"
+
+/*
+Drives an XInputController from a recorded session (see XInputRecorder.h).
+Each record is decoded and pushed through the public setters, then sent,
+so SOCD cleaning, deadzones and curves configured on the controller are
+applied on top of the recording. Ranges should be left at their defaults
+so recorded values pass through unscaled.
+
+There are no delays between records: a session replays as fast as the
+CPU allows. Auto-send is turned off on the controller while replaying,
+and its previous setting is restored after the last record (or when the
+replay is destroyed). Attach an XInputRecorder to the controller to capture the
+output, then check it against a golden log with compare().
+*/
+
+class XInputReplay {
+public:
+	XInputReplay(XInputController & controller, const uint8_t * stream, size_t len);
+	~XInputReplay();
+
+	void rewind();
+	bool step();      // Applies the next record. false at the end of the stream.
+	uint32_t run();   // Applies all remaining records, returns the count
+
+	uint32_t frame() const { return decoder.frame(); }  // Recorded frame of the last record
+	bool done() const { return position >= length; }
+	bool failed() const { return corrupt; }  // Stopped on a malformed record
+
+	// Compares the reports of two recordings byte-for-byte, ignoring frame
+	// timing. Returns -1 if they match, otherwise the index of the first
+	// differing (or malformed) record.
+	static int32_t compare(const uint8_t * a, size_t aLen, const uint8_t * b, size_t bLen);
+
+private:
+	XInputController & pad;
+	const uint8_t * const data;
+	const size_t length;
+	size_t position;
+	bool corrupt;
+
+	bool savedAutoSend;  // Controller's setting, restored at the end
+	bool holdingAutoSend;
+	void releaseAutoSend();
+
+	XInputRecordDecoder decoder;
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "XInputStream.h"
+
+// --------------------------------------------------------
+// XInputStream Class                                     |
+// --------------------------------------------------------
+
+#ifdef XINPUT_STREAM_SIMULATED
+boolean (*XInputStream::simSink)(const uint8_t * packet, uint8_t len) = nullptr;
+#endif
+
+XInputStream::XInputStream() :
+	packet(), fill(0), sent(0), dropped(0)
+{}
+
+size_t XInputStream::write(uint8_t b) {
+	return write(&b, 1);
+}
+
+size_t XInputStream::write(const uint8_t * data, size_t len) {
+	if (len == 0) return 0;
+
+	// A full packet left over from last time goes first
+	if (fill == PacketSize) {
+		if (!sendPacket(PacketSize)) {
+			dropped++;
+			return 0;
+		}
+		fill = 0;
+	}
+
+	// Full packets this write completes, all of them must fit
+	const size_t packets = (fill + len) / PacketSize;
+	if (packets > queueSpace()) {
+		dropped++;
+		return 0;  // Error: Queue full, keep the stream whole
+	}
+
+	size_t remaining = len;
+	while (remaining > 0) {
+		const uint8_t n = min((size_t) (PacketSize - fill), remaining);
+		memcpy(packet + fill, data, n);
+		fill += n;
+		data += n;
+		remaining -= n;
+
+		if (fill == PacketSize) {
+			if (!sendPacket(PacketSize)) break;  // Buffer pool ran out, retried on the next write
+			fill = 0;
+		}
+	}
+	if (remaining > 0) {
+		// Shouldn't happen: the queue had room but a buffer couldn't be
+		// allocated. The bytes are in order, only the tail is lost.
+		dropped++;
+	}
+	return len - remaining;
+}
+
+void XInputStream::flush() {
+	if (fill == 0) return;
+	if (sendPacket(fill)) fill = 0;
+}
+
+void XInputStream::discard() {
+	fill = 0;
+}
+
+uint8_t XInputStream::queueSpace() const {
+#ifdef XINPUT_STREAM_SIMULATED
+	return simSink != nullptr ? 255 : 0;
+#else
+	return XInputUSB::bulkFree();
+#endif
+}
+
+boolean XInputStream::sendPacket(uint8_t len) {
+#ifdef XINPUT_STREAM_SIMULATED
+	if (simSink == nullptr || !simSink(packet, len)) return false;
+#else
+	if (XInputUSB::bulkSend(packet, len) <= 0) return false;
+#endif
+	sent += len;
+	return true;
+}
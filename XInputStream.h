@@ -0,0 +1,90 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_STREAM_H
+#define XINPUT_STREAM_H
+
+#include "XInput.h"
+
+/*
+Diagnostics stream over the vendor bulk interface of the XInput + WinUSB
+USB type. Writes are batched into full 64-byte bulk packets, so the host
+gets the most data per transaction, and bulk transfers only use the
+bandwidth left after the XInput interrupt endpoint.
+
+It's a Print, so telemetry goes straight in:
+
+  XInputStream stream;
+  XInput.printTelemetry(stream);  // 36-byte frame
+  stream.flush();                 // Send a partial packet now
+
+Each write() is kept whole. If the queue can't take all of it, it's
+dropped and counted, rather than leaving a torn frame for the host.
+See extras/xinput_stream.py for the reader.
+
+Without the bulk interface (e.g. on the host), packets go to the
+function passed to setSink().
+*/
+
+#if !defined(XINPUT_BULK_INTERFACE)
+#define XINPUT_STREAM_SIMULATED
+#endif
+
+class XInputStream : public Print {
+public:
+	static const uint8_t PacketSize = 64;
+
+	XInputStream();
+
+	size_t write(uint8_t b);
+	size_t write(const uint8_t * data, size_t len);
+	using Print::write;
+
+	void flush();     // Sends the partial packet, if any
+	void discard();   // Drops the partial packet
+
+	uint32_t bytesSent() const { return sent; }
+	uint32_t writesDropped() const { return dropped; }
+
+#ifdef XINPUT_STREAM_SIMULATED
+	static void setSink(boolean (*sink)(const uint8_t * packet, uint8_t len)) { simSink = sink; }
+#endif
+
+private:
+	uint8_t packet[PacketSize];
+	uint8_t fill;  // Bytes in 'packet'
+	uint32_t sent;
+	uint32_t dropped;
+
+	uint8_t queueSpace() const;  // Packets the endpoint can take now
+	boolean sendPacket(uint8_t len);
+
+#ifdef XINPUT_STREAM_SIMULATED
+	static boolean (*simSink)(const uint8_t * packet, uint8_t len);
+#endif
+};
+
+#endif
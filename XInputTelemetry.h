@@ -0,0 +1,134 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef XINPUT_TELEMETRY_H
+#define XINPUT_TELEMETRY_H
+
+// No Arduino dependencies, so the decoder can also be built on the host
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+Binary telemetry frame, little-endian:
+
+  Offset  Size  Field
+  0       2     Sync (0x58 0xA5)
+  2       1     Payload length (32)
+  3       20    Report, as sent to the host
+  23      2     Rumble, left (large) then right (small)
+  25      1     LED pattern
+  26      1     Player
+  27      4     USB frame number
+  31      2     Last send duration, us
+  33      2     Longest send duration, us
+  35      1     Checksum, XOR of the payload bytes
+*/
+
+struct XInputTelemetryFrame {
+	uint8_t  report[20];
+	uint8_t  rumbleLeft;
+	uint8_t  rumbleRight;
+	uint8_t  ledPattern;
+	uint8_t  player;
+	uint32_t frame;
+	uint16_t sendTimeLast;
+	uint16_t sendTimeMax;
+};
+
+class XInputTelemetry {
+public:
+	static const uint8_t Sync0 = 0x58;  // 'X'
+	static const uint8_t Sync1 = 0xA5;
+	static const uint8_t PayloadSize = 32;
+	static const uint8_t FrameSize = 2 + 1 + PayloadSize + 1;
+
+	static uint8_t encode(const XInputTelemetryFrame & in, uint8_t * out) {
+		uint8_t * p = out + 3;
+		memcpy(p, in.report, sizeof(in.report)); p += sizeof(in.report);
+		*p++ = in.rumbleLeft;
+		*p++ = in.rumbleRight;
+		*p++ = in.ledPattern;
+		*p++ = in.player;
+		p = put32(p, in.frame);
+		p = put16(p, in.sendTimeLast);
+		p = put16(p, in.sendTimeMax);
+
+		out[0] = Sync0;
+		out[1] = Sync1;
+		out[2] = PayloadSize;
+		out[FrameSize - 1] = checksum(out + 3);
+		return FrameSize;
+	}
+
+	// Finds and decodes the next frame in 'data'. Returns the number of bytes
+	// consumed, including any skipped garbage. 'valid' is set if 'out' was
+	// filled. A return of 0 means more data is needed.
+	static size_t decode(const uint8_t * data, size_t len, XInputTelemetryFrame & out, bool & valid) {
+		valid = false;
+		size_t skip = 0;
+		while (skip + 1 < len && !(data[skip] == Sync0 && data[skip + 1] == Sync1)) skip++;
+		if (len - skip < FrameSize) return skip;
+
+		const uint8_t * f = data + skip;
+		if (f[2] != PayloadSize || checksum(f + 3) != f[FrameSize - 1]) {
+			return skip + 1;  // False sync, resume scanning after it
+		}
+
+		const uint8_t * p = f + 3;
+		memcpy(out.report, p, sizeof(out.report)); p += sizeof(out.report);
+		out.rumbleLeft = *p++;
+		out.rumbleRight = *p++;
+		out.ledPattern = *p++;
+		out.player = *p++;
+		out.frame = p[0] | (p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24); p += 4;
+		out.sendTimeLast = p[0] | (p[1] << 8); p += 2;
+		out.sendTimeMax = p[0] | (p[1] << 8);
+
+		valid = true;
+		return skip + FrameSize;
+	}
+
+private:
+	static uint8_t * put16(uint8_t * p, uint16_t v) {
+		*p++ = v & 0xFF;
+		*p++ = v >> 8;
+		return p;
+	}
+
+	static uint8_t * put32(uint8_t * p, uint32_t v) {
+		p = put16(p, v & 0xFFFF);
+		return put16(p, v >> 16);
+	}
+
+	static uint8_t checksum(const uint8_t * payload) {
+		uint8_t sum = 0;
+		for (uint8_t i = 0; i < PayloadSize; i++) sum ^= payload[i];
+		return sum;
+	}
+};
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Minimal assertions for the host tests
+
+#ifndef XINPUT_TEST_CHECK_H
+#define XINPUT_TEST_CHECK_H
+
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+// Counts and prints a failure, and keeps going
+#define CHECK(cond) do { \
+	if (!(cond)) { printf("%s:%d: FAIL: %s\n", __FILE__, __LINE__, #cond); checkFailures++; } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+	const long _a = (long) (a), _b = (long) (b); \
+	if (_a != _b) { printf("%s:%d: FAIL: %s == %s (%ld != %ld)\n", __FILE__, __LINE__, #a, #b, _a, _b); checkFailures++; } \
+} while (0)
+
+// Returned from main()
+static inline int checkResult(const char * name) {
+	printf("%s: %s\n", name, checkFailures == 0 ? "PASS" : "FAIL");
+	return checkFailures == 0 ? 0 : 1;
+}
+
+#endif
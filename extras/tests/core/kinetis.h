@@ -0,0 +1,105 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Host stand-in for the Teensy kinetis.h, for the core tests that include
+// usb_dev.c. The USB module registers are plain variables the test reads
+// and writes in place of the hardware. Each test is one translation unit,
+// so they are defined here.
+
+#ifndef XINPUT_TEST_KINETIS_H
+#define XINPUT_TEST_KINETIS_H
+
+#include <stdint.h>
+
+volatile uint32_t SIM_SCGC4;
+volatile uint32_t MPU_RGDAAC0;
+volatile uint8_t USB0_INTEN, USB0_ERRSTAT, USB0_ERREN, USB0_STAT;
+volatile uint8_t USB0_CTL, USB0_ADDR, USB0_FRMNUM, USB0_OTGISTAT;
+volatile uint8_t USB0_BDTPAGE1, USB0_BDTPAGE2, USB0_BDTPAGE3;
+volatile uint8_t USB0_ENDPT[16 * 4];  // ENDPTn every 4 bytes
+volatile uint8_t USB0_USBCTRL, USB0_CONTROL, USB0_USBTRC0;
+volatile uint8_t USB0_CLK_RECOVER_CTRL, USB0_CLK_RECOVER_IRC_EN;
+
+// USB0_ISTAT flags are write-1-to-clear, which a variable can't do. The
+// test raises them in usb0_istat_raised, and reading USB0_ISTAT takes
+// them: usb_isr() reads it once per pass and clears what it handled.
+volatile uint8_t usb0_istat_raised, usb0_istat_taken;
+static inline volatile uint8_t * usb0_istat(void)
+{
+	usb0_istat_taken = usb0_istat_raised;
+	usb0_istat_raised = 0;
+	return &usb0_istat_taken;
+}
+#define USB0_ISTAT		(*usb0_istat())
+
+#define USB0_ENDPT0		USB0_ENDPT[0]
+#define USB0_ENDPT1		USB0_ENDPT[4]
+
+#define SIM_SCGC4_USBOTG			0x00040000
+#define USB_ISTAT_USBRST			0x01
+#define USB_ISTAT_ERROR				0x02
+#define USB_ISTAT_SOFTOK			0x04
+#define USB_ISTAT_TOKDNE			0x08
+#define USB_ISTAT_SLEEP				0x10
+#define USB_ISTAT_RESUME			0x20
+#define USB_ISTAT_STALL				0x80
+#define USB_INTEN_USBRSTEN			0x01
+#define USB_INTEN_ERROREN			0x02
+#define USB_INTEN_SOFTOKEN			0x04
+#define USB_INTEN_TOKDNEEN			0x08
+#define USB_INTEN_SLEEPEN			0x10
+#define USB_INTEN_RESUMEEN			0x20
+#define USB_INTEN_STALLEN			0x80
+#define USB_CTL_USBENSOFEN			0x01
+#define USB_CTL_ODDRST				0x02
+#define USB_CTL_RESUME				0x04
+#define USB_ENDPT_EPHSHK			0x01
+#define USB_ENDPT_EPSTALL			0x02
+#define USB_ENDPT_EPTXEN			0x04
+#define USB_ENDPT_EPRXEN			0x08
+#define USB_USBCTRL_SUSP			0x80
+#define USB_CONTROL_DPPULLUPNONOTG		0x10
+#define USB_USBTRC_USB_RESUME_INT		0x01
+#define USB_USBTRC_USBRESMEN			0x20
+#define USB_USBTRC_USBRESET			0x80
+#define USB_CLK_RECOVER_IRC_EN_REG_EN		0x01
+#define USB_CLK_RECOVER_IRC_EN_IRC_EN		0x02
+#define USB_CLK_RECOVER_CTRL_RESTART_IFRTRIM_EN	0x40
+#define USB_CLK_RECOVER_CTRL_CLOCK_RECOVER_EN	0x80
+
+// Single-threaded, nothing to hold off
+#define __disable_irq()
+#define __enable_irq()
+
+#define IRQ_USBOTG		73
+#define NVIC_ENABLE_IRQ(irq)
+#define NVIC_SET_PRIORITY(irq, priority)
+
+// The systick and the rest of the vector table, driven by the test
+extern volatile uint32_t systick_millis_count;
+extern void (* _VectorsRam[])(void);
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Host stand-in for the Teensy usb_mem.h, for the core tests only
+
+#ifndef XINPUT_TEST_USB_MEM_H
+#define XINPUT_TEST_USB_MEM_H
+
+#include <stdint.h>
+
+// usb_dev.c finds a packet from its buffer, 8 bytes in as on the board.
+// On a 64-bit host 'next' doesn't fit in front of it.
+typedef struct usb_packet_struct {
+	uint16_t len;
+	uint16_t index;
+	uint32_t reserved;
+	uint8_t buf[64];
+	struct usb_packet_struct *next;
+} usb_packet_t;
+
+usb_packet_t * usb_malloc(void);
+void usb_free(usb_packet_t *packet);
+
+#endif
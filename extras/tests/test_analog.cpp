@@ -0,0 +1,165 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Analog sampler, on the simulated DMA: averaging at each oversample,
+// an inverted axis, nothing read before the first set, and update()
+// sending one report with all the axes
+
+#include "XInput.h"
+#include "XInputAnalog.h"
+#include "XInputRecorder.h"
+#include "check.h"
+
+static uint8_t oversample = 1;
+
+// Axis 'a' steps through base, base + 10, ... within each set, so a set
+// averages to base + 5 * (oversample - 1) exactly
+static uint16_t ramp(uint8_t axis, uint32_t sample) {
+	return 1000 * (axis + 1) + (sample % oversample) * 10;
+}
+
+static uint16_t fixed(uint8_t axis, uint32_t sample) {
+	static const uint16_t Values[4] = { 4095, 0, 4095, 1000 };
+	return Values[axis];
+}
+
+static void averaging() {
+	const XInputAnalogAxis axes[] = {
+		{ 5, JOY_LEFT, false, false },
+		{ 14, JOY_LEFT, true, false },
+	};
+	XInputAnalogSampler sampler(axes, 2);
+	sampler.simulate(ramp);
+
+	for (oversample = 1; oversample <= XInputAnalogSampler::MaxOversample; oversample <<= 1) {
+		CHECK(sampler.begin(1000, oversample));
+		for (uint8_t set = 0; set < 3; set++) {
+			sampler.tick();
+			CHECK_EQ(sampler.read((uint8_t) 0), 1000 + 5 * (oversample - 1));  // (uint8_t): a plain 0 is also a null pointer
+			CHECK_EQ(sampler.read(1), 2000 + 5 * (oversample - 1));
+		}
+		CHECK_EQ(sampler.sets(), 3);
+		sampler.end();
+	}
+
+	CHECK(!sampler.begin(1000, 3));  // Not a power of two
+	CHECK(!sampler.begin(1000, 32));  // More than MaxOversample
+	CHECK(!sampler.begin(1000, 0));
+}
+
+static void inverted() {
+	const XInputAnalogAxis axes[] = {
+		{ 5, JOY_LEFT, false, false },
+		{ 14, JOY_LEFT, true, true },
+	};
+	XInputAnalogSampler sampler(axes, 2);
+	sampler.simulate(ramp);
+	oversample = 4;
+	CHECK(sampler.begin(1000, oversample));
+	sampler.tick();
+	CHECK_EQ(sampler.read((uint8_t) 0), 1015);
+	CHECK_EQ(sampler.read(1), 4095 - 2015);
+	sampler.end();
+}
+
+static void firstSet() {
+	const XInputAnalogAxis axes[] = {
+		{ 8, TRIGGER_LEFT, false, false },
+	};
+	XInputAnalogSampler sampler(axes, 1);
+	sampler.simulate(fixed);
+
+	uint16_t values[XInputAnalogSampler::MaxAxes];
+	CHECK(!sampler.read(values));  // Not started
+	CHECK(sampler.begin(1000, 4));
+	CHECK(!sampler.read(values));  // Started, no set yet
+	CHECK_EQ(sampler.sets(), 0);
+
+	sampler.tick();
+	CHECK(sampler.read(values));
+	CHECK_EQ(values[0], 4095);
+	CHECK_EQ(sampler.read(5), 0);  // Not an axis
+	sampler.end();
+}
+
+static void update() {
+	const XInputAnalogAxis axes[] = {
+		{ 5, JOY_LEFT, false, false },   // 4095
+		{ 14, JOY_LEFT, true, false },   // 0
+		{ 8, TRIGGER_RIGHT, false, false },  // 4095
+		{ 9, JOY_RIGHT, false, true },   // 1000, inverted
+	};
+	XInputAnalogSampler sampler(axes, 4);
+	sampler.simulate(fixed);
+
+	uint8_t store[256];
+	XInputRecorder rec(store, sizeof(store));
+	XInputController pad;
+	pad.setJoystickRange(0, 4095);
+	pad.setTriggerRange(0, 4095);
+	pad.setRecorder(&rec);
+	CHECK(pad.getAutoSend());
+
+	CHECK(sampler.begin(1000, 4));
+	sampler.update(pad);  // No set yet, nothing applied
+	CHECK_EQ(rec.records(), 0);
+	CHECK_EQ(pad.getJoystickX(JOY_LEFT), 0);
+
+	sampler.tick();
+	sampler.update(pad);
+	CHECK_EQ(rec.records(), 1);  // One report with every axis, not one per setter
+	CHECK(pad.getAutoSend());
+	CHECK_EQ(pad.getJoystickX(JOY_LEFT), 32767);
+	CHECK_EQ(pad.getJoystickY(JOY_LEFT), -32768);
+	CHECK_EQ(pad.getTrigger(TRIGGER_RIGHT), 255);
+	CHECK_EQ(pad.getTrigger(TRIGGER_LEFT), 0);
+	CHECK_EQ(pad.getJoystickX(JOY_RIGHT), map(4095 - 1000, 0, 4095, -32768, 32767));
+	CHECK(abs(pad.getJoystickY(JOY_RIGHT)) < 16);  // Unsampled, centered
+
+	sampler.tick();
+	sampler.update(pad);  // Same values, same report
+	CHECK_EQ(rec.records(), 1);
+
+	// With auto send off it's left to the caller
+	pad.setAutoSend(false);
+	sampler.simulate(ramp);
+	oversample = 1;
+	sampler.tick();
+	sampler.update(pad);
+	CHECK_EQ(rec.records(), 1);
+	CHECK(!pad.getAutoSend());
+	pad.send();
+	CHECK_EQ(rec.records(), 2);
+	sampler.end();
+}
+
+int main() {
+	averaging();
+	inverted();
+	firstSet();
+	update();
+	return checkResult("analog");
+}
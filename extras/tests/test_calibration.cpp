@@ -0,0 +1,134 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Calibration: learn rest, min and max from raw samples, finish(), then
+// check the fixed-point transforms at the ends of travel and in the deadband
+
+#include "XInputCalibration.h"
+#include "check.h"
+
+static const uint8_t RestSamples = 4;
+
+// Rest first (the first samples are averaged), then a sweep across min-max
+static void learn(XInputCalibration & cal, uint8_t axis, int32_t rest, int32_t min, int32_t max) {
+	for (uint8_t i = 0; i < RestSamples; i++) {
+		int32_t v = rest;
+		cal.transform(axis, v);
+	}
+	for (int32_t raw = min; raw <= max; raw += 10) {
+		int32_t v = raw;
+		CHECK(!cal.transform(axis, v));  // Passed through while learning
+		CHECK_EQ(v, raw);
+	}
+	int32_t v = max;
+	cal.transform(axis, v);
+}
+
+static int32_t out(XInputCalibration & cal, uint8_t axis, int32_t raw) {
+	int32_t v = raw;
+	if (!cal.transform(axis, v)) return INT32_MIN;  // Not calibrated
+	return v;
+}
+
+static void offCenterStick() {
+	XInputCalibration cal;
+	cal.start(RestSamples);
+	learn(cal, XInputCalibration::LeftX, 600, 100, 900);  // Rest well off the middle
+	CHECK_EQ(cal.finish(), 1 << XInputCalibration::LeftX);
+	CHECK(!cal.learning());
+
+	CHECK_EQ(out(cal, XInputCalibration::LeftX, 100), -32768);
+	CHECK_EQ(out(cal, XInputCalibration::LeftX, 600), 0);
+	CHECK_EQ(out(cal, XInputCalibration::LeftX, 900), 32767);
+	CHECK_EQ(out(cal, XInputCalibration::LeftX, 0), -32768);  // Past the learned ends, clamped
+	CHECK_EQ(out(cal, XInputCalibration::LeftX, 1023), 32767);
+
+	// Both halves are scaled on their own, so halfway each side is about half
+	const int32_t lowHalf = out(cal, XInputCalibration::LeftX, 345);
+	const int32_t highHalf = out(cal, XInputCalibration::LeftX, 753);
+	CHECK(lowHalf < -16000 && lowHalf > -17000);
+	CHECK(highHalf > 16000 && highHalf < 17000);
+}
+
+static void deadband() {
+	XInputCalibration cal;
+	cal.start(RestSamples);
+	learn(cal, XInputCalibration::RightY, 500, 0, 1000);
+	cal.finish();
+
+	// Default 2% of each side: 490-510 reads as rest
+	CHECK_EQ(out(cal, XInputCalibration::RightY, 491), 0);
+	CHECK_EQ(out(cal, XInputCalibration::RightY, 509), 0);
+	CHECK(out(cal, XInputCalibration::RightY, 489) < 0);
+	CHECK(out(cal, XInputCalibration::RightY, 511) > 0);
+
+	// 10% deadband (450-550), rebuilt from the same points. Ends still reach full scale.
+	cal.setDeadband(100);
+	CHECK_EQ(out(cal, XInputCalibration::RightY, 460), 0);
+	CHECK_EQ(out(cal, XInputCalibration::RightY, 540), 0);
+	CHECK_EQ(out(cal, XInputCalibration::RightY, 549), 0);
+	CHECK(out(cal, XInputCalibration::RightY, 551) > 0);
+	CHECK_EQ(out(cal, XInputCalibration::RightY, 0), -32768);
+	CHECK_EQ(out(cal, XInputCalibration::RightY, 1000), 32767);
+}
+
+static void invertedTrigger() {
+	XInputCalibration cal;
+	cal.start(RestSamples);
+	learn(cal, XInputCalibration::TriggerLeft, 1000, 200, 1000);  // Rests high, pulls low
+	CHECK_EQ(cal.finish(), 1 << XInputCalibration::TriggerLeft);
+
+	CHECK_EQ(out(cal, XInputCalibration::TriggerLeft, 1000), 0);
+	CHECK_EQ(out(cal, XInputCalibration::TriggerLeft, 990), 0);  // In the deadband
+	CHECK_EQ(out(cal, XInputCalibration::TriggerLeft, 200), 65535);
+	const int32_t mid = out(cal, XInputCalibration::TriggerLeft, 592);
+	CHECK(mid > 32000 && mid < 34000);
+	CHECK(out(cal, XInputCalibration::TriggerLeft, 400) > mid);  // Further pulled is more
+}
+
+static void rejected() {
+	XInputCalibration cal;
+	cal.start(RestSamples);
+	learn(cal, XInputCalibration::LeftY, 512, 512, 512);  // Never moved
+	learn(cal, XInputCalibration::RightX, 512, 500, 1000);  // One side barely moved
+	learn(cal, XInputCalibration::TriggerRight, 0, 0, 1000);
+	CHECK_EQ(cal.finish(), 1 << XInputCalibration::TriggerRight);
+
+	CHECK(!cal.calibrated(XInputCalibration::LeftY));
+	CHECK(!cal.calibrated(XInputCalibration::RightX));
+	CHECK(!cal.calibrated(XInputCalibration::LeftX));  // Never sampled
+	CHECK_EQ(out(cal, XInputCalibration::LeftY, 700), INT32_MIN);
+	CHECK_EQ(out(cal, XInputCalibration::TriggerRight, 0), 0);
+	CHECK_EQ(out(cal, XInputCalibration::TriggerRight, 1000), 65535);
+}
+
+int main() {
+	offCenterStick();
+	deadband();
+	invertedTrigger();
+	rejected();
+	return checkResult("calibration");
+}
@@ -0,0 +1,84 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Config channel reads: Info, and telemetry served from the snapshot that
+// service() takes in the loop rather than packed in the USB interrupt
+
+#include "XInput.h"
+#include "XInputConfig.h"
+#include "check.h"
+
+static uint16_t readButtons(XInputConfigChannel & config, int & size) {
+	uint8_t buf[XInputConfigChannel::MaxData];
+	size = config.transfer(true, XInputConfigChannel::Telemetry, 0, buf, sizeof(buf));
+
+	XInputTelemetryFrame frame;
+	bool valid = false;
+	XInputTelemetry::decode(buf, size > 0 ? size : 0, frame, valid);
+	if (!valid) return 0xFFFF;
+	return frame.report[2] | (frame.report[3] << 8);
+}
+
+static void info() {
+	XInputController pad;
+	XInputConfigChannel config(pad);
+	config.begin();
+
+	uint8_t buf[XInputConfigChannel::MaxData];
+	CHECK_EQ(config.transfer(true, XInputConfigChannel::Info, 0, buf, sizeof(buf)), 4);
+	CHECK_EQ(buf[0], XInputConfigChannel::Version);
+	CHECK_EQ(buf[1], XInputController::MaxControllers);
+	config.end();
+}
+
+static void telemetrySnapshot() {
+	XInputController pad;
+	pad.setAutoSend(false);
+	XInputConfigChannel config(pad);
+	config.begin();
+
+	int size;
+	readButtons(config, size);
+	CHECK_EQ(size, 0);  // Nothing until the first service()
+
+	pad.press(BUTTON_A);
+	config.service();
+	pad.press(BUTTON_B);  // After the snapshot
+	CHECK_EQ(readButtons(config, size), 0x1000);
+	CHECK_EQ(size, XInputTelemetry::FrameSize);
+
+	config.service();  // Read, so this one refreshes
+	pad.release(BUTTON_A);
+	config.service();  // Not read since, kept
+	CHECK_EQ(readButtons(config, size), 0x3000);
+	config.end();
+}
+
+int main() {
+	info();
+	telemetrySnapshot();
+	return checkResult("config");
+}
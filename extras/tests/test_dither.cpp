@@ -0,0 +1,101 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Trigger dither: slow 16-bit ramps packed into the 8-bit report, with and
+// without dither, and the effective resolution after the host averages a
+// few reports. An ideal 8-bit quantizer scores 8 bits.
+
+#include <math.h>
+
+#include "XInput.h"
+#include "XInputRecorder.h"
+#include "check.h"
+
+static uint8_t store[256];
+
+// RMS error of the packed output, averaged over 'window' frames, against
+// the 16-bit input averaged the same way. In 8-bit steps.
+static double rampError(boolean dither, uint8_t window, uint32_t start, uint32_t frames) {
+	XInputController pad;
+	pad.setAutoSend(false);
+	pad.setTriggerRange(0, 65535);
+	pad.setTriggerDither(dither);
+	XInputRecorder rec(store, sizeof(store));
+	pad.setRecorder(&rec);
+	XInputRecordDecoder dec;
+
+	uint8_t out = 0;
+	double sumIn = 0, sumOut = 0, sumSq = 0;
+	uint32_t count = 0;
+
+	for (uint32_t f = 0; f < frames; f++) {
+		const uint32_t in = start + f / 4;  // One 16-bit step every 4 frames, 1/1028 of an 8-bit step per frame
+		pad.setTrigger(TRIGGER_LEFT, in);
+		hostMicros += 1000;
+		pad.send();
+
+		uint8_t buf[64];
+		const size_t len = rec.read(buf, sizeof(buf));
+		for (size_t pos = 0; pos < len; ) {
+			const size_t used = dec.decode(buf + pos, len - pos);
+			if (used == 0 || used == XInputRecordDecoder::Malformed) break;
+			out = dec.report()[4];
+			pos += used;
+		}
+
+		sumIn += in / 257.0;
+		sumOut += out;
+		if ((f + 1) % window == 0) {
+			const double e = (sumOut - sumIn) / window;
+			sumSq += e * e;
+			count++;
+			sumIn = sumOut = 0;
+		}
+	}
+	return sqrt(sumSq / count);
+}
+
+static double effectiveBits(double rms) {
+	return 8.0 + log2((1.0 / sqrt(12.0)) / rms);  // Against uniform rounding error
+}
+
+int main() {
+	static const uint32_t Start = 10000, Frames = 40000;  // Ramps across about 40 output steps
+
+	double bits[2][3];
+	static const uint8_t Windows[3] = { 1, 4, 16 };
+	for (uint8_t d = 0; d < 2; d++) {
+		for (uint8_t w = 0; w < 3; w++) {
+			bits[d][w] = effectiveBits(rampError(d != 0, Windows[w], Start, Frames));
+			printf("dither %s, %2u-report average: %.1f effective bits\n", d ? "on " : "off", Windows[w], bits[d][w]);
+		}
+	}
+
+	CHECK(fabs(bits[0][2] - 8.0) < 0.5);  // Rounding, averaging doesn't help
+	CHECK(bits[1][1] > bits[0][1] + 1.0);
+	CHECK(bits[1][2] > 11.0);
+	return checkResult("dither");
+}
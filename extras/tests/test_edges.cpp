@@ -0,0 +1,156 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Edge capture: taps between two service() calls reach the host with and
+// without frame sync, a full ring still ends on the right state, and the
+// edge-to-report latency measured against polling the pins at 1 kHz
+
+#include "XInputEdges.h"
+#include "XInputRecorder.h"
+#include "check.h"
+
+constexpr XInputPin Pins[] = {
+	{ XInputPort::D, 0, BUTTON_A },
+	{ XInputPort::D, 1, BUTTON_B },
+};
+constexpr XInputPortTables Tables = XINPUT_PORT_TABLES(Pins);
+
+static const uint32_t Idle = 0xFFFFFFFF;  // Active-low, nothing pressed
+static const uint32_t PressA = ~(uint32_t) 0x01;
+static const uint32_t PressB = ~(uint32_t) 0x02;
+
+static uint8_t store[1024];
+
+static void tap(boolean frameSync) {
+	XInputController pad;
+	pad.setAutoSend(false);
+	pad.setFrameSync(frameSync);
+	XInputRecorder rec(store, sizeof(store));
+	pad.setRecorder(&rec);
+
+	XInputPortScanner scanner(Tables);
+	XInputEdgeCapture edges(scanner);
+	XInputPortScanner::simulate(XInputPort::D, Idle);
+
+	// Press and release A between two services
+	hostMicros = 100;
+	XInputPortScanner::simulate(XInputPort::D, PressA);
+	edges.inject(100);
+	XInputPortScanner::simulate(XInputPort::D, Idle);
+	edges.inject(300);
+	CHECK_EQ(edges.pending(), 2);
+
+	hostMicros = 1000;
+	CHECK_EQ(edges.service(pad), 2);
+	CHECK_EQ(edges.pending(), 0);
+	if (frameSync) pad.pushFrame();
+	else pad.send();
+
+	CHECK_EQ(rec.records(), 2);  // Press, then release
+	CHECK(!pad.getButton(BUTTON_A));
+}
+
+static void overflow() {
+	XInputController pad;
+	pad.setAutoSend(false);
+	XInputPortScanner scanner(Tables);
+	XInputEdgeCapture edges(scanner);
+
+	// More changes than the ring holds, ending with B held
+	for (uint8_t i = 0; i < 2 * XInputEdgeCapture::RingSize; i++) {
+		XInputPortScanner::simulate(XInputPort::D, (i & 1) ? PressB : PressA);
+		edges.inject(i);
+	}
+	CHECK(edges.overflows() > 0);
+	CHECK_EQ(edges.pending(), XInputEdgeCapture::RingSize - 1);
+
+	edges.service(pad);
+	CHECK(!pad.getButton(BUTTON_A));
+	CHECK(pad.getButton(BUTTON_B));
+}
+
+static uint32_t rng = 1;
+static uint32_t random32() {
+	rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+	return rng;
+}
+
+static uint32_t nextTick(uint32_t t, uint32_t period, uint32_t phase) {
+	return t <= phase ? phase : phase + ((t - phase + period - 1) / period) * period;
+}
+
+// Random edges, taken either by polling the pins every 1 ms or by capture
+// with service() once per pass of a 50 us loop. 'merged' is edge to the
+// controller holding the change, 'frame' is edge to the next USB frame
+// after that (at an unrelated 1 ms phase), when the host can have it.
+static void latency() {
+	static const uint32_t PollUs = 1000, LoopUs = 50, FrameUs = 1000, FramePhase = 370;
+	static const uint32_t Edges = 10000;
+
+	XInputController pad;
+	pad.setAutoSend(false);
+	XInputPortScanner scanner(Tables);
+	XInputEdgeCapture edges(scanner);
+	XInputPortScanner::simulate(XInputPort::D, Idle);
+
+	uint64_t pollMerged = 0, pollFrame = 0, capMerged = 0, capFrame = 0;
+	uint32_t pollMergedMax = 0, capMergedMax = 0;
+
+	uint32_t t = 10000;
+	for (uint32_t i = 0; i < Edges; i++) {
+		t += 2000 + random32() % 3000;  // Edges 2-5 ms apart
+		XInputPortScanner::simulate(XInputPort::D, (i & 1) ? Idle : PressA);
+
+		const uint32_t poll = nextTick(t, PollUs, 0);
+		pollMerged += poll - t;
+		pollFrame += nextTick(poll, FrameUs, FramePhase) - t;
+		if (poll - t > pollMergedMax) pollMergedMax = poll - t;
+
+		edges.inject(t);
+		hostMicros = nextTick(t, LoopUs, 0);
+		CHECK_EQ(edges.service(pad), 1);
+		const uint32_t merged = XInputEdgeCapture::ticksToMicros(edges.latency());
+		capMerged += merged;
+		capFrame += nextTick(hostMicros, FrameUs, FramePhase) - t;
+		if (merged > capMergedMax) capMergedMax = merged;
+	}
+
+	printf("1 kHz poll: merged avg %u max %u us, to frame avg %u us\n",
+		(unsigned) (pollMerged / Edges), (unsigned) pollMergedMax, (unsigned) (pollFrame / Edges));
+	printf("capture:    merged avg %u max %u us, to frame avg %u us\n",
+		(unsigned) (capMerged / Edges), (unsigned) capMergedMax, (unsigned) (capFrame / Edges));
+
+	CHECK(capMergedMax < LoopUs);
+	CHECK(capFrame < pollFrame);
+}
+
+int main() {
+	tap(false);
+	tap(true);
+	overflow();
+	latency();
+	return checkResult("edges");
+}
@@ -0,0 +1,173 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// DirectInput mirror: where translate() puts each XInput control in the
+// 12-byte joystick report. Fields are packed LSB first and several
+// straddle bytes.
+
+#include "XInputDirectInput.h"
+#include "check.h"
+
+#include <string.h>
+
+// Joystick report fields, first bit and width
+static const uint16_t Hat = 32, X = 36, Y = 46, Z = 56, Rz = 66, Slider1 = 76, Slider2 = 86;
+static const uint8_t AxisBits = 10;
+
+static uint32_t field(const uint8_t * report, uint16_t bit, uint8_t width) {
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < width; i++, bit++) {
+		value |= (uint32_t) ((report[bit >> 3] >> (bit & 7)) & 1) << i;
+	}
+	return value;
+}
+
+struct Pad {
+	uint16_t buttons;
+	uint8_t lt, rt;
+	int16_t lx, ly, rx, ry;
+};
+
+static void translate(const Pad & pad, uint8_t * report) {
+	uint8_t x[20] = { 0x00, 0x14 };
+	x[2] = pad.buttons & 0xFF;
+	x[3] = pad.buttons >> 8;
+	x[4] = pad.lt;
+	x[5] = pad.rt;
+	const int16_t axes[4] = { pad.lx, pad.ly, pad.rx, pad.ry };
+	for (uint8_t i = 0; i < 4; i++) {
+		x[6 + i * 2] = axes[i] & 0xFF;
+		x[7 + i * 2] = (uint16_t) axes[i] >> 8;
+	}
+	XInputJoystickMirror mirror;
+	mirror.translate(x, report);
+}
+
+static void centered() {
+	uint8_t r[XInputJoystickMirror::Size];
+	translate(Pad(), r);
+	CHECK_EQ(field(r, 0, 32), 0);
+	CHECK_EQ(field(r, Hat, 4), 15);
+	CHECK_EQ(field(r, X, AxisBits), 512);
+	CHECK_EQ(field(r, Y, AxisBits), 511);  // Flipped
+	CHECK_EQ(field(r, Z, AxisBits), 512);
+	CHECK_EQ(field(r, Rz, AxisBits), 511);
+	CHECK_EQ(field(r, Slider1, AxisBits), 0);
+	CHECK_EQ(field(r, Slider2, AxisBits), 0);
+}
+
+static void buttons() {
+	// XInput button word bit, joystick button bit
+	static const uint8_t Buttons[][2] = {
+		{ 12, 0 }, { 13, 1 }, { 14, 2 }, { 15, 3 },  // A B X Y
+		{ 8, 4 }, { 9, 5 },    // LB RB
+		{ 5, 6 }, { 4, 7 },    // Back Start
+		{ 6, 8 }, { 7, 9 }, { 10, 10 },  // L3 R3 Logo
+	};
+	uint8_t r[XInputJoystickMirror::Size];
+	for (const auto & b : Buttons) {
+		Pad pad = {};
+		pad.buttons = 1 << b[0];
+		translate(pad, r);
+		CHECK_EQ(field(r, 0, 32), 1UL << b[1]);
+		CHECK_EQ(field(r, Hat, 4), 15);
+	}
+}
+
+static void hat() {
+	// D-pad bits: up 1, down 2, left 4, right 8
+	static const uint8_t Positions[][2] = {
+		{ 0x1, 0 }, { 0x9, 1 }, { 0x8, 2 }, { 0xA, 3 },
+		{ 0x2, 4 }, { 0x6, 5 }, { 0x4, 6 }, { 0x5, 7 },
+		{ 0x3, 15 }, { 0xC, 15 }, { 0xD, 0 },  // Opposites cancel
+	};
+	uint8_t r[XInputJoystickMirror::Size];
+	for (const auto & p : Positions) {
+		Pad pad = {};
+		pad.buttons = p[0];
+		translate(pad, r);
+		CHECK_EQ(field(r, Hat, 4), p[1]);
+		CHECK_EQ(field(r, 0, 32), 0);  // Not buttons
+	}
+}
+
+static void axes() {
+	uint8_t r[XInputJoystickMirror::Size];
+	Pad pad = {};
+
+	pad.lx = 32767;
+	pad.ly = 32767;  // Up, so 0 in HID
+	pad.rx = -32768;
+	pad.ry = -32768;
+	translate(pad, r);
+	CHECK_EQ(field(r, X, AxisBits), 1023);
+	CHECK_EQ(field(r, Y, AxisBits), 0);
+	CHECK_EQ(field(r, Z, AxisBits), 0);
+	CHECK_EQ(field(r, Rz, AxisBits), 1023);
+	CHECK_EQ(field(r, Hat, 4), 15);
+	CHECK_EQ(field(r, Slider1, AxisBits), 0);
+
+	pad = Pad();
+	pad.lx = -32768;
+	pad.ly = -32768;
+	pad.rx = 32767;
+	pad.ry = 32767;
+	translate(pad, r);
+	CHECK_EQ(field(r, X, AxisBits), 0);
+	CHECK_EQ(field(r, Y, AxisBits), 1023);
+	CHECK_EQ(field(r, Z, AxisBits), 1023);
+	CHECK_EQ(field(r, Rz, AxisBits), 0);
+
+	// One field at a time, the others stay centered
+	pad = Pad();
+	pad.rx = 16384;
+	translate(pad, r);
+	CHECK_EQ(field(r, X, AxisBits), 512);
+	CHECK_EQ(field(r, Y, AxisBits), 511);
+	CHECK_EQ(field(r, Z, AxisBits), 768);
+	CHECK_EQ(field(r, Rz, AxisBits), 511);
+}
+
+static void triggers() {
+	uint8_t r[XInputJoystickMirror::Size];
+	Pad pad = {};
+	pad.lt = 255;
+	pad.rt = 128;
+	translate(pad, r);
+	CHECK_EQ(field(r, Slider1, AxisBits), 1023);
+	CHECK_EQ(field(r, Slider2, AxisBits), (128 * 257) >> 6);
+	CHECK_EQ(field(r, Rz, AxisBits), 511);
+}
+
+int main() {
+	CHECK_EQ(XInputJoystickMirror::Size, 12);
+	centered();
+	buttons();
+	hat();
+	axes();
+	triggers();
+	return checkResult("mirror");
+}
@@ -0,0 +1,122 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// High resolution mouse in the core (usb_xinput.c): sub-count motion in
+// both directions, flicks bigger than a report, and wheel input piling up
+// while the host isn't taking reports
+
+#define USB_XINPUT_KEYBOARD_MOUSE
+#define MOUSE_HIRES 1
+#include "usb_xinput.c"
+#include <stdlib.h>
+#include "check.h"
+
+static int queued = 0;  // Reports waiting on the mouse endpoint
+static long totalX = 0, totalY = 0, totalWheel = 0;
+static int reports = 0, largest = 0;
+
+// Core state, normally in usb_dev.c
+volatile uint8_t usb_configuration = 1;
+volatile uint32_t usb_sof_count = 0;
+volatile uint8_t usb_suspended = 0;
+volatile uint8_t usb_state = USB_STATE_CONFIGURED;
+volatile uint32_t usb_state_millis[USB_STATE_COUNT];
+volatile uint32_t usb_tx_frame[NUM_ENDPOINTS];
+uint16_t usb_rx_byte_count_data[NUM_ENDPOINTS];
+
+static usb_packet_t packet;
+
+uint32_t millis(void) { return 0; }
+void yield(void) {}
+usb_packet_t * usb_malloc(void) { return &packet; }
+void usb_free(usb_packet_t *p) { (void) p; }
+usb_packet_t * usb_rx(uint32_t endpoint) { (void) endpoint; return NULL; }
+uint32_t usb_tx_packet_count(uint32_t endpoint) { return endpoint == MOUSE_HIRES_ENDPOINT ? queued : 0; }
+uint32_t usb_tx_busy(uint32_t endpoint) { (void) endpoint; return 0; }
+void usb_tx_discard(uint32_t endpoint) { (void) endpoint; }
+int usb_remote_wakeup(void) { return 0; }
+void usb_soft_reconnect(uint32_t ms) { (void) ms; }
+
+void usb_tx(uint32_t endpoint, usb_packet_t *p)
+{
+	if (endpoint != MOUSE_HIRES_ENDPOINT) return;
+	const int16_t x = (int16_t) (p->buf[1] | (p->buf[2] << 8));
+	const int16_t y = (int16_t) (p->buf[3] | (p->buf[4] << 8));
+	totalX += x;
+	totalY += y;
+	totalWheel += (int8_t) p->buf[5];
+	if (abs(x) > largest) largest = abs(x);
+	reports++;
+}
+
+static void clear(void)
+{
+	totalX = totalY = totalWheel = 0;
+	reports = largest = 0;
+}
+
+static void frames(int n)
+{
+	while (n--) usb_mouse_hires_frame();
+}
+
+int main(void)
+{
+	// 0.3 counts a frame, both ways. Whole counts go out, the fraction
+	// stays, so 1000 frames add up instead of rounding to nothing.
+	usb_mouse_hires_velocity(77, -77);
+	frames(1000);
+	usb_mouse_hires_velocity(0, 0);
+	CHECK_EQ(totalX, 77L * 1000 / 256);
+	CHECK_EQ(totalY, -301);  // floor(-300.8)
+	clear();
+
+	// A flick bigger than a report carries over to the next frames
+	usb_mouse_hires_move(-30000, 0, 0, 0);
+	usb_mouse_hires_move(-30000, 0, 0, 0);
+	frames(5);
+	CHECK_EQ(totalX, -60000);
+	CHECK(largest <= 32767);
+	clear();
+
+	// Wheel input while the queue is full is kept, up to a few reports' worth
+	queued = TX_PACKET_LIMIT;
+	for (int i = 0; i < 1000; i++) usb_mouse_hires_move(0, 0, 127, 0);
+	frames(10);
+	CHECK_EQ(reports, 0);
+	queued = 0;
+	frames(10);
+	CHECK_EQ(totalWheel, MOUSE_WHEEL_MAX);
+	clear();
+
+	queued = TX_PACKET_LIMIT;
+	for (int i = 0; i < 1000; i++) usb_mouse_hires_move(0, 0, -128, 0);
+	queued = 0;
+	frames(10);
+	CHECK_EQ(totalWheel, -MOUSE_WHEEL_MAX);
+
+	return checkResult("mouse");
+}
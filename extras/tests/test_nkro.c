@@ -0,0 +1,148 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// N-key rollover keyboard in the core (usb_xinput.c): one report per
+// change, nothing when the report is unchanged, and each modifier and key
+// code in its own bit
+
+#define USB_XINPUT_KEYBOARD_MOUSE
+#define KEYBOARD_NKRO 1
+#include "usb_xinput.c"
+#include "check.h"
+
+// Codes as in keylayouts.h
+#define MODIFIERKEY_CTRL        (0x01 | 0xE000)
+#define MODIFIERKEY_RIGHT_GUI   (0x80 | 0xE000)
+#define KEY_A                   (   4 | 0xF000)
+#define KEY_ESC                 (  41 | 0xF000)
+#define KEY_RIGHT_SHIFT         (0xE5 | 0xF000)
+#define KEY_MEDIA_VOLUME_INC    (0xE9 | 0xE400)
+
+static int reports = 0;
+static uint8_t last[KEYBOARD_NKRO_SIZE];
+
+// Core state, normally in usb_dev.c
+volatile uint8_t usb_configuration = 1;
+volatile uint32_t usb_sof_count = 0;
+volatile uint8_t usb_suspended = 0;
+volatile uint8_t usb_state = USB_STATE_CONFIGURED;
+volatile uint32_t usb_state_millis[USB_STATE_COUNT];
+volatile uint32_t usb_tx_frame[NUM_ENDPOINTS];
+uint16_t usb_rx_byte_count_data[NUM_ENDPOINTS];
+
+static usb_packet_t packet;
+
+uint32_t millis(void) { return 0; }
+void yield(void) {}
+usb_packet_t * usb_malloc(void) { return &packet; }
+void usb_free(usb_packet_t *p) { (void) p; }
+usb_packet_t * usb_rx(uint32_t endpoint) { (void) endpoint; return NULL; }
+uint32_t usb_tx_packet_count(uint32_t endpoint) { (void) endpoint; return 0; }
+uint32_t usb_tx_busy(uint32_t endpoint) { (void) endpoint; return 0; }
+void usb_tx_discard(uint32_t endpoint) { (void) endpoint; }
+int usb_remote_wakeup(void) { return 0; }
+void usb_soft_reconnect(uint32_t ms) { (void) ms; }
+
+void usb_tx(uint32_t endpoint, usb_packet_t *p)
+{
+	if (endpoint != KEYBOARD_NKRO_ENDPOINT) return;
+	CHECK_EQ(p->len, KEYBOARD_NKRO_SIZE);
+	memcpy(last, p->buf, KEYBOARD_NKRO_SIZE);
+	reports++;
+}
+
+static int bits(void)
+{
+	int n = 0;
+	for (int i = 0; i < KEYBOARD_NKRO_SIZE; i++) n += __builtin_popcount(last[i]);
+	return n;
+}
+
+static int press(uint16_t key, bool pressed)
+{
+	usb_keyboard_nkro_set(key, pressed);
+	return usb_keyboard_nkro_send();
+}
+
+int main(void)
+{
+	// One report per change, each key in its own bit
+	CHECK_EQ(press(KEY_A, true), 1);
+	CHECK_EQ(reports, 1);
+	CHECK_EQ(last[1 + 4 / 8], 1 << (4 % 8));
+	CHECK_EQ(bits(), 1);
+
+	CHECK_EQ(press(KEY_ESC, true), 1);
+	CHECK_EQ(reports, 2);
+	CHECK_EQ(last[1 + 41 / 8], 1 << (41 % 8));
+	CHECK_EQ(bits(), 2);
+
+	// Unchanged report sends nothing
+	CHECK_EQ(press(KEY_A, true), 0);
+	CHECK_EQ(usb_keyboard_nkro_send(), 0);
+	CHECK_EQ(reports, 2);
+
+	CHECK_EQ(press(KEY_A, false), 1);
+	CHECK_EQ(reports, 3);
+	CHECK_EQ(last[1 + 4 / 8], 0);
+	CHECK_EQ(bits(), 1);
+
+	// Modifiers go in byte 0, as a MODIFIERKEY_* mask or a KEY_* usage
+	CHECK_EQ(press(MODIFIERKEY_CTRL, true), 1);
+	CHECK_EQ(last[0], 0x01);
+	CHECK_EQ(press(KEY_RIGHT_SHIFT, true), 1);
+	CHECK_EQ(last[0], 0x01 | 0x20);
+	CHECK_EQ(press(MODIFIERKEY_RIGHT_GUI, true), 1);
+	CHECK_EQ(last[0], 0x01 | 0x20 | 0x80);
+	CHECK_EQ(press(KEY_RIGHT_SHIFT, false), 1);
+	CHECK_EQ(last[0], 0x01 | 0x80);
+	CHECK_EQ(reports, 7);
+
+	// A plain usage, the last one in the bitmap
+	CHECK_EQ(press(119, true), 1);
+	CHECK_EQ(last[KEYBOARD_NKRO_SIZE - 1], 0x80);
+
+	// Codes past the bitmap and media keys are ignored
+	CHECK_EQ(press(120, true), 0);
+	CHECK_EQ(press(0xDF, true), 0);
+	CHECK_EQ(press(KEY_MEDIA_VOLUME_INC, true), 0);
+	CHECK_EQ(reports, 8);
+	CHECK_EQ(bits(), 4);  // Esc, Ctrl, GUI, 119
+
+	// Release all is one report
+	usb_keyboard_nkro_clear();
+	CHECK_EQ(usb_keyboard_nkro_send(), 1);
+	CHECK_EQ(reports, 9);
+	CHECK_EQ(bits(), 0);
+	CHECK_EQ(usb_keyboard_nkro_send(), 0);
+
+	// No host, no report
+	usb_state = USB_STATE_SUSPENDED;
+	CHECK_EQ(press(KEY_A, true), -1);
+	CHECK_EQ(reports, 9);
+
+	return checkResult("nkro");
+}
@@ -0,0 +1,139 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Port scanner: tables generated at compile time from a pin map, checked
+// against reading each pin on its own for many port values, and pin maps
+// that don't fit
+
+#include "XInputPorts.h"
+#include "check.h"
+
+constexpr XInputPin Pins[] = {
+	{ XInputPort::D, 0, BUTTON_A },
+	{ XInputPort::D, 7, BUTTON_B },
+	{ XInputPort::D, 1, BUTTON_X },  // Same nibble as A
+	{ XInputPort::A, 12, DPAD_UP },
+	{ XInputPort::A, 13, DPAD_DOWN },
+	{ XInputPort::C, 31, BUTTON_START, true },
+	{ XInputPort::B, 16, BUTTON_LB, true },
+	{ XInputPort::E, 26, BUTTON_LOGO },
+};
+constexpr XInputPortTables Tables = XINPUT_PORT_TABLES(Pins);
+
+// Built by the compiler
+static_assert(XInputPortTables::check(Pins), "Pin map fits");
+static_assert(Tables.valid, "Pin map fits");
+static_assert(Tables.numGroups == 6, "D0-3, D4-7, A12-15, C28-31, B16-19, E24-27");
+static_assert(Tables.portsUsed == 0x1F, "All five ports");
+static_assert(Tables.groups[0].port == 3 && Tables.groups[0].shift == 0, "First group is D0-3");
+static_assert(Tables.groups[0].table[0x3] == (0x1000 | 0x4000), "A and X");
+static_assert(Tables.groups[0].invert == 0x3, "Active-low");
+static_assert(Tables.groups[3].invert == 0x0, "Start is active-high");
+
+// Nine nibbles, one too many
+constexpr XInputPin TooMany[] = {
+	{ XInputPort::A, 0, BUTTON_A }, { XInputPort::A, 4, BUTTON_B }, { XInputPort::A, 8, BUTTON_X },
+	{ XInputPort::A, 12, BUTTON_Y }, { XInputPort::A, 16, BUTTON_LB }, { XInputPort::A, 20, BUTTON_RB },
+	{ XInputPort::A, 24, BUTTON_START }, { XInputPort::A, 28, BUTTON_BACK }, { XInputPort::B, 0, BUTTON_LOGO },
+};
+constexpr XInputPortTables TooManyTables = XINPUT_PORT_TABLES(TooMany);
+static_assert(!XInputPortTables::check(TooMany), "Ninth nibble doesn't fit");
+static_assert(TooManyTables.numGroups == 8, "Eight kept");
+static_assert(!(TooManyTables.buttonMask & 0x0400), "Logo left out");
+static_assert(TooManyTables.portsUsed == 0x01, "Port B never read");
+
+constexpr XInputPin NotButtons[] = {
+	{ XInputPort::A, 0, BUTTON_A },
+	{ XInputPort::C, 3, TRIGGER_LEFT },
+	{ XInputPort::C, 40, BUTTON_B },
+};
+static_assert(!XInputPortTables::check(NotButtons), "Trigger and bit 40 are left out");
+
+// Each pin read on its own, as digitalRead() would
+static uint16_t reference(const XInputPin * pins, size_t count, const uint32_t * ports) {
+	uint16_t buttons = 0;
+	for (size_t i = 0; i < count; i++) {
+		const bool level = ports[(uint8_t) pins[i].port] & (1UL << pins[i].bit);
+		if (level == pins[i].activeHigh) buttons |= XInputController::getButtonMask(pins[i].control);
+	}
+	return buttons;
+}
+
+static uint32_t rng = 12345;
+static uint32_t random32() {
+	rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+	return rng;
+}
+
+static void matchesReference() {
+	XInputPortScanner scanner(Tables);
+	CHECK(scanner.valid());
+	CHECK_EQ(scanner.mask(), 0x1000 | 0x2000 | 0x4000 | 0x0001 | 0x0002 | 0x0010 | 0x0100 | 0x0400);
+
+	uint32_t ports[XInputPortTables::NumPorts];
+	for (uint32_t n = 0; n < 100000; n++) {
+		for (uint8_t p = 0; p < XInputPortTables::NumPorts; p++) {
+			ports[p] = random32();
+			XInputPortScanner::simulate((XInputPort) p, ports[p]);
+		}
+		const uint16_t expected = reference(Pins, sizeof(Pins) / sizeof(Pins[0]), ports);
+		const uint16_t got = scanner.scan();
+		if (got != expected) {
+			CHECK_EQ(got, expected);
+			return;
+		}
+	}
+}
+
+static void invalidMaps() {
+	XInputPortScanner scanner(TooManyTables);
+	CHECK(!scanner.valid());
+
+	for (uint8_t p = 0; p < XInputPortTables::NumPorts; p++) XInputPortScanner::simulate((XInputPort) p, 0);
+	CHECK_EQ(scanner.scan(), 0xF000 | 0x0300 | 0x0030);  // All low: the kept active-low buttons, no logo
+}
+
+static void update() {
+	XInputController pad;
+	pad.setAutoSend(false);
+	pad.press(BUTTON_Y);  // Not in the map, left alone
+
+	XInputPortScanner scanner(Tables);
+	for (uint8_t p = 0; p < XInputPortTables::NumPorts; p++) XInputPortScanner::simulate((XInputPort) p, 0xFFFFFFFF);
+	XInputPortScanner::simulate(XInputPort::D, ~(uint32_t) 0x01);  // A low
+	scanner.update(pad);
+	CHECK(pad.getButton(BUTTON_A));
+	CHECK(pad.getButton(BUTTON_Y));
+	CHECK(pad.getButton(BUTTON_START));  // Active-high, reads 1
+	CHECK(!pad.getButton(BUTTON_LOGO));
+}
+
+int main() {
+	matchesReference();
+	invalidMaps();
+	update();
+	return checkResult("ports");
+}
@@ -0,0 +1,154 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Recorder and decoder: round trip, incomplete vs malformed input, and the
+// byte rates behind the capacity figures in XInputRecorder.h
+
+#include "XInputRecorder.h"
+#include "check.h"
+
+#include <string.h>
+
+static uint8_t ring[64 * 1024];
+
+static void makeReport(uint8_t * r, uint16_t buttons, int16_t lx, int16_t ly, int16_t rx, int16_t ry) {
+	memset(r, 0, XInputRecorder::ReportSize);
+	r[1] = 0x14;
+	r[2] = buttons & 0xFF;
+	r[3] = buttons >> 8;
+	const int16_t axes[4] = { lx, ly, rx, ry };
+	for (uint8_t i = 0; i < 4; i++) {
+		r[6 + i * 2] = axes[i] & 0xFF;
+		r[7 + i * 2] = (uint16_t) axes[i] >> 8;
+	}
+}
+
+static void roundTrip() {
+	XInputRecorder rec(ring, sizeof(ring));
+	uint8_t reports[4][XInputRecorder::ReportSize];
+	makeReport(reports[0], 0x0000, 0, 0, 0, 0);
+	makeReport(reports[1], 0x1000, 0, 0, 0, 0);
+	makeReport(reports[2], 0x1000, 32767, -32768, 0, 0);
+	makeReport(reports[3], 0x0000, 32767, -32768, 0, 0);
+	const uint32_t frames[4] = { 100, 101, 120, 70000 };  // Inline, inline, varint, long varint
+
+	for (uint8_t i = 0; i < 4; i++) CHECK(rec.record(reports[i], frames[i]));
+
+	uint8_t stream[256];
+	const size_t len = rec.read(stream, sizeof(stream));
+
+	XInputRecordDecoder dec;
+	size_t pos = 0;
+	for (uint8_t i = 0; i < 4; i++) {
+		const size_t used = dec.decode(stream + pos, len - pos);
+		CHECK(used != 0 && used != XInputRecordDecoder::Malformed);
+		if (used == 0 || used == XInputRecordDecoder::Malformed) return;
+		pos += used;
+		CHECK(memcmp(dec.report(), reports[i], XInputRecorder::ReportSize) == 0);
+		CHECK_EQ(dec.frame(), frames[i] - frames[0]);
+	}
+	CHECK_EQ(pos, len);
+
+	// Every cut short of a whole record is incomplete, not malformed
+	XInputRecordDecoder part;
+	for (size_t cut = 0; cut < len; cut++) {
+		part.reset();
+		size_t p = 0, used;
+		while ((used = part.decode(stream + p, cut - p)) != 0) {
+			CHECK(used != XInputRecordDecoder::Malformed);
+			if (used == XInputRecordDecoder::Malformed) return;
+			p += used;
+		}
+	}
+}
+
+static void malformed() {
+	XInputRecordDecoder dec;
+
+	const uint8_t emptyMask[] = { 0x00, 0x00, 0x10 };
+	CHECK_EQ(dec.decode(emptyMask, sizeof(emptyMask)), XInputRecordDecoder::Malformed);
+
+	const uint8_t typeByte[] = { 0x01, 0x00, 0x00, 0x00 };  // Byte 0 never changes
+	CHECK_EQ(dec.decode(typeByte, sizeof(typeByte)), XInputRecordDecoder::Malformed);
+
+	const uint8_t unusedBytes[] = { 0x00, 0x40, 0x00, 0x01 };  // Byte 14
+	CHECK_EQ(dec.decode(unusedBytes, sizeof(unusedBytes)), XInputRecordDecoder::Malformed);
+
+	const uint8_t badSize[] = { 0x02, 0x00, 0x00, 0x99 };
+	CHECK_EQ(dec.decode(badSize, sizeof(badSize)), XInputRecordDecoder::Malformed);
+
+	const uint8_t longVarint[] = { 0x04, 0x00, 0xF0, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x01 };
+	CHECK_EQ(dec.decode(longVarint, sizeof(longVarint)), XInputRecordDecoder::Malformed);
+
+	const uint8_t cutVarint[] = { 0x04, 0x00, 0xF0, 0xFF };
+	CHECK_EQ(dec.decode(cutVarint, sizeof(cutVarint)), 0);
+
+	// State untouched by the failures
+	uint8_t zero[XInputRecorder::ReportSize] = {};
+	CHECK(memcmp(dec.report(), zero, sizeof(zero)) == 0);
+	CHECK_EQ(dec.frame(), 0);
+}
+
+// Bytes per second of continuous motion, one report per 1 ms frame. The
+// worst case changes every stick byte every frame; a sweep moves the stick
+// across its full range once per second, so the high bytes change less.
+static size_t rate(bool bothSticks, bool worst) {
+	XInputRecorder rec(ring, sizeof(ring));
+	uint8_t report[XInputRecorder::ReportSize];
+	for (uint32_t frame = 0; frame < 1000; frame++) {
+		int16_t a, b;
+		if (worst) {
+			a = (int16_t)((frame & 0xFF) * 0x0101);
+			b = (int16_t)(((frame + 128) & 0xFF) * 0x0101);
+		}
+		else {
+			const int32_t t = frame < 500 ? frame : 1000 - frame;  // Triangle
+			a = (int16_t)(t * 131 - 32768);
+			b = (int16_t)(32767 - t * 131);
+		}
+		makeReport(report, 0, a, b, bothSticks ? b : 0, bothSticks ? a : 0);
+		rec.record(report, frame);
+	}
+	CHECK_EQ(rec.dropped(), 0);
+	return rec.available();
+}
+
+int main() {
+	roundTrip();
+	malformed();
+
+	const size_t worstOne = rate(false, true), worstBoth = rate(true, true);
+	const size_t sweepOne = rate(false, false), sweepBoth = rate(true, false);
+	printf("worst case: %u B/s one stick, %u B/s both\n", (unsigned) worstOne, (unsigned) worstBoth);
+	printf("full sweep: %u B/s one stick, %u B/s both\n", (unsigned) sweepOne, (unsigned) sweepBoth);
+	printf("200 KB ring: %u-%u s one stick, %u-%u s both\n",
+		(unsigned)(200000 / worstOne), (unsigned)(200000 / sweepOne),
+		(unsigned)(200000 / worstBoth), (unsigned)(200000 / sweepBoth));
+	CHECK(worstOne > 6900 && worstOne <= 7 * 1000);  // 3 header + 4 stick bytes per frame
+	CHECK(worstBoth > 10900 && worstBoth <= 11 * 1000);
+
+	return checkResult("recorder");
+}
@@ -0,0 +1,154 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Replay against a golden log: a short recorded session is replayed through
+// a controller, its output is recorded, and the result must match the
+// expected report sequence through XInputReplay::compare()
+
+#include "XInput.h"
+#include "XInputRecorder.h"
+#include "XInputReplay.h"
+#include "check.h"
+
+// Recorded session, 8 records. Record 3 holds up and down together.
+static const uint8_t SessionLog[] = {
+	0x02, 0x00, 0x00, 0x14, 0x08, 0x00, 0xF0, 0x01, 0x10, 0x0C, 0x00, 0x50,
+	0x09, 0x00, 0x04, 0x00, 0xF0, 0x19, 0x03, 0x34, 0x00, 0x30, 0x00, 0x80,
+	0xFF, 0xC8, 0x02, 0x10, 0x01, 0xFF, 0x7F, 0x80, 0x30, 0x3C, 0xF0, 0x9D,
+	0x02, 0x00, 0x00, 0x18, 0xFC, 0xE8, 0x03, 0xC8, 0x3E, 0x20, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+struct Expected {
+	uint16_t buttons;
+	uint8_t triggers[2];
+	int16_t joysticks[4];
+};
+
+// What the controller sends for it, with the default (up priority) SOCD
+// cleaning applied to record 3
+static const Expected Golden[] = {
+	{ 0x0000, {   0,   0 }, {     0,      0,     0,    0 } },
+	{ 0x1000, {   0,   0 }, {     0,      0,     0,    0 } },  // A
+	{ 0x0009, {   0,   0 }, {     0,      0,     0,    0 } },  // Up + right
+	{ 0x0001, {   0,   0 }, {     0,      0,     0,    0 } },  // Up + down, cleaned
+	{ 0x0000, { 128, 255 }, {     0,      0,     0,    0 } },
+	{ 0x0100, { 128, 255 }, { 32767, -32768,     0,    0 } },  // LB
+	{ 0x0100, {   0,   0 }, { 32767, -32768, -1000, 1000 } },
+	{ 0x0000, {   0,   0 }, {     0,      0,     0,    0 } },
+};
+static const uint8_t GoldenCount = sizeof(Golden) / sizeof(Golden[0]);
+
+static uint8_t outRing[1024], goldenRing[1024];
+static uint8_t outLog[1024], goldenLog[1024];
+
+static size_t buildGolden() {
+	XInputRecorder rec(goldenRing, sizeof(goldenRing));
+	for (uint8_t i = 0; i < GoldenCount; i++) {
+		const Expected & e = Golden[i];
+		uint8_t r[XInputRecorder::ReportSize] = {};
+		r[1] = 0x14;
+		r[2] = lowByte(e.buttons);
+		r[3] = highByte(e.buttons);
+		r[4] = e.triggers[0];
+		r[5] = e.triggers[1];
+		for (uint8_t j = 0; j < 4; j++) {
+			r[6 + j * 2] = lowByte(e.joysticks[j]);
+			r[7 + j * 2] = highByte((uint16_t) e.joysticks[j]);
+		}
+		rec.record(r, i);
+	}
+	return rec.read(goldenLog, sizeof(goldenLog));
+}
+
+static void golden() {
+	const size_t goldenLen = buildGolden();
+
+	XInputController pad;
+	XInputRecorder rec(outRing, sizeof(outRing));
+	pad.setRecorder(&rec);
+
+	XInputReplay replay(pad, SessionLog, sizeof(SessionLog));
+	CHECK_EQ(replay.run(), GoldenCount);
+	CHECK(!replay.failed());
+	CHECK_EQ(rec.records(), GoldenCount);
+
+	const size_t outLen = rec.read(outLog, sizeof(outLog));
+	CHECK_EQ(XInputReplay::compare(outLog, outLen, goldenLog, goldenLen), -1);
+
+	// The raw session differs from the golden output at the cleaned record,
+	// as does a replay with different cleaning
+	CHECK_EQ(XInputReplay::compare(SessionLog, sizeof(SessionLog), goldenLog, goldenLen), 3);
+
+	XInputController neutral;
+	XInputRecorder rec2(outRing, sizeof(outRing));
+	neutral.setSOCDMode(XInputSOCD::Neutral);
+	neutral.setRecorder(&rec2);
+	XInputReplay replay2(neutral, SessionLog, sizeof(SessionLog));
+	replay2.run();
+	const size_t len2 = rec2.read(outLog, sizeof(outLog));
+	CHECK_EQ(XInputReplay::compare(outLog, len2, goldenLog, goldenLen), 3);
+}
+
+// Auto-send is off while replaying and comes back afterwards
+static void autoSend() {
+	XInputController pad;
+	pad.setAutoSend(true);
+	{
+		XInputReplay replay(pad, SessionLog, sizeof(SessionLog));
+		CHECK(!pad.getAutoSend());
+		CHECK(replay.step());
+		CHECK(!pad.getAutoSend());
+		replay.run();
+		CHECK(pad.getAutoSend());  // Restored after the last record
+
+		replay.rewind();
+		CHECK(!pad.getAutoSend());
+		replay.step();
+	}
+	CHECK(pad.getAutoSend());  // Restored by the destructor
+
+	pad.setAutoSend(false);
+	{
+		XInputReplay replay(pad, SessionLog, sizeof(SessionLog));
+		replay.run();
+	}
+	CHECK(!pad.getAutoSend());  // Off stays off
+
+	// A corrupt stream fails, and restores it too
+	const uint8_t corrupt[] = { 0x02, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00 };
+	pad.setAutoSend(true);
+	XInputReplay replay(pad, corrupt, sizeof(corrupt));
+	CHECK_EQ(replay.run(), 1);
+	CHECK(replay.failed());
+	CHECK(pad.getAutoSend());
+}
+
+int main() {
+	golden();
+	autoSend();
+	return checkResult("replay");
+}
@@ -0,0 +1,152 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// SOCD cleaning matrix: every policy against press and release orders on
+// both axes, through each input path (setDpad, setButtons, digital stick)
+
+#include "XInput.h"
+#include "check.h"
+
+// Direction bits, in report order
+static const uint8_t U = 0x01, D = 0x02, L = 0x04, R = 0x08;
+
+static const XInputSOCD Modes[] = {
+	XInputSOCD::UpPriority, XInputSOCD::Neutral, XInputSOCD::LastInput, XInputSOCD::FirstInput,
+};
+static const char * const ModeNames[] = { "UpPriority", "Neutral", "LastInput", "FirstInput" };
+
+struct Step {
+	uint8_t in;       // Held directions
+	uint8_t out[4];   // Expected output, per mode above
+};
+
+struct Sequence {
+	const char * name;
+	Step steps[5];
+	uint8_t count;
+};
+
+#define ALL(x) { x, x, x, x }
+
+static const Sequence Sequences[] = {
+	{ "L, +R, -L", { { L, ALL(L) }, { L|R, { 0, 0, R, L } }, { R, ALL(R) }, { 0, ALL(0) } }, 4 },
+	{ "L, +R, -R", { { L, ALL(L) }, { L|R, { 0, 0, R, L } }, { L, ALL(L) }, { 0, ALL(0) } }, 4 },
+	{ "R, +L, -R", { { R, ALL(R) }, { L|R, { 0, 0, L, R } }, { L, ALL(L) }, { 0, ALL(0) } }, 4 },
+	{ "R, +L, -L", { { R, ALL(R) }, { L|R, { 0, 0, L, R } }, { R, ALL(R) }, { 0, ALL(0) } }, 4 },
+	{ "L+R together, -R, +R", { { L|R, ALL(0) }, { L, ALL(L) }, { L|R, { 0, 0, R, L } }, { 0, ALL(0) } }, 4 },
+	{ "U, +D, -U", { { U, ALL(U) }, { U|D, { U, 0, D, U } }, { D, ALL(D) }, { 0, ALL(0) } }, 4 },
+	{ "U, +D, -D", { { U, ALL(U) }, { U|D, { U, 0, D, U } }, { U, ALL(U) }, { 0, ALL(0) } }, 4 },
+	{ "D, +U, -D", { { D, ALL(D) }, { U|D, { U, 0, U, D } }, { U, ALL(U) }, { 0, ALL(0) } }, 4 },
+	{ "D, +U, -U", { { D, ALL(D) }, { U|D, { U, 0, U, D } }, { D, ALL(D) }, { 0, ALL(0) } }, 4 },
+	{ "U+D together, -U, +U", { { U|D, { U, 0, 0, 0 } }, { D, ALL(D) }, { U|D, { U, 0, U, D } }, { 0, ALL(0) } }, 4 },
+	{ "diagonal, +R, -L", { { U|L, ALL(U|L) }, { U|L|R, { U, U, U|R, U|L } }, { U|R, ALL(U|R) }, { 0, ALL(0) } }, 4 },
+	{ "all four, staggered", { { U, ALL(U) }, { U|L, ALL(U|L) }, { U|D|L, { U|L, L, D|L, U|L } },
+		{ U|D|L|R, { U, 0, D|R, U|L } }, { 0, ALL(0) } }, 5 },
+};
+
+enum class Path { Dpad, Buttons, Stick };
+static const char * const PathNames[] = { "setDpad", "setButtons", "setJoystick" };
+
+static void apply(XInputController & pad, Path path, uint8_t in) {
+	const bool up = in & U, down = in & D, left = in & L, right = in & R;
+	switch (path) {
+	case Path::Dpad:    pad.setDpad(up, down, left, right); break;
+	case Path::Buttons: pad.setButtons(in, U | D | L | R); break;
+	case Path::Stick:   pad.setJoystick(JOY_LEFT, up, down, left, right); break;
+	}
+}
+
+static uint8_t read(const XInputController & pad, Path path) {
+	if (path == Path::Stick) {
+		const int16_t x = pad.getJoystickX(JOY_LEFT), y = pad.getJoystickY(JOY_LEFT);
+		return (y > 0 ? U : 0) | (y < 0 ? D : 0) | (x < 0 ? L : 0) | (x > 0 ? R : 0);
+	}
+	return pad.getButtons() & (U | D | L | R);
+}
+
+static void runMatrix() {
+	for (uint8_t p = 0; p < 3; p++) {
+		for (uint8_t m = 0; m < 4; m++) {
+			for (const Sequence & seq : Sequences) {
+				XInputController pad;
+				pad.setAutoSend(false);
+				pad.setSOCDMode(Modes[m]);
+
+				for (uint8_t i = 0; i < seq.count; i++) {
+					apply(pad, (Path) p, seq.steps[i].in);
+					const uint8_t got = read(pad, (Path) p);
+					if (got != seq.steps[i].out[m]) {
+						printf("  %s / %s / %s, step %u: got 0x%X, expected 0x%X\n",
+							PathNames[p], ModeNames[m], seq.name, i, got, seq.steps[i].out[m]);
+						checkFailures++;
+					}
+				}
+			}
+		}
+	}
+}
+
+// setButtons() with a mask that only covers some directions. The others
+// must be cleaned from what is held, not from the last cleaned output.
+static void runPartialMask() {
+	for (uint8_t m = 0; m < 4; m++) {
+		XInputController pad;
+		pad.setAutoSend(false);
+		pad.setSOCDMode(Modes[m]);
+
+		pad.setButtons(L, L);
+		CHECK_EQ(read(pad, Path::Buttons), L);
+
+		pad.setButtons(R, R);  // L is still held
+		const uint8_t both[4] = { 0, 0, R, L };
+		CHECK_EQ(read(pad, Path::Buttons), both[m]);
+
+		pad.setButtons(0, R);  // L comes back
+		CHECK_EQ(read(pad, Path::Buttons), L);
+
+		pad.setButtons(0x1000, 0x1000);  // A, leaves the d-pad alone
+		CHECK_EQ(read(pad, Path::Buttons), L);
+
+		pad.setButtons(0, L);
+		CHECK_EQ(read(pad, Path::Buttons), 0);
+	}
+}
+
+// Without cleaning, opposites pass through
+static void runUncleaned() {
+	XInputController pad;
+	pad.setAutoSend(false);
+	pad.setSOCDMode(XInputSOCD::Neutral);
+	pad.setDpad(true, true, true, true, false);
+	CHECK_EQ(read(pad, Path::Dpad), U | D | L | R);
+}
+
+int main() {
+	runMatrix();
+	runPartialMask();
+	runUncleaned();
+	return checkResult("socd");
+}
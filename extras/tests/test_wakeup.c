@@ -0,0 +1,192 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Remote wakeup in the core (usb_dev.c, usb_xinput.c), against a model
+// host: the bus suspends, a press asks for a wakeup, the systick handler
+// waits out the idle time and drives the K state, the host resumes and
+// takes the first report. Prints the wakeup time the core measures.
+
+#define USB_XINPUT
+#include "usb_dev.c"
+#include "usb_xinput.c"
+#include "check.h"
+
+// Model host, with the resume timing from the USB 2.0 spec (7.1.7.7,
+// 7.1.7.5): it drives resume for 20 ms once it sees the K state, then
+// gives the device 10 ms to recover before polling again.
+static const uint32_t ResumeMs = 20;    // TDRSMDN
+static const uint32_t RecoveryMs = 10;  // TRSMRCY
+
+// Press to first report: the rest of the bus idle time (5 ms, suspend is
+// seen after 3), the host's resume and recovery, and two frames, one for
+// the poll and one for the SOF that notices it
+static const uint32_t BudgetMs = 2 + ResumeMs + RecoveryMs + 2;
+
+static int frames = 1;        // host sending SOFs
+static int polling = 1;       // host taking reports
+static uint32_t resume_at = 0, poll_at = 0;  // ms the host resumes, polls again
+static int reports = 0;
+
+// The startup code's systick and vector table
+volatile uint32_t systick_millis_count = 0;
+void (* _VectorsRam[16])(void);
+
+// Tables from usb_desc.c, empty: enumeration isn't modeled
+const usb_descriptor_list_t usb_descriptor_list[] = {{0, 0, NULL, 0}};
+const usb_control_handler_list_t usb_control_handler_list[] = {{0, 0, 0, NULL, NULL}};
+const uint8_t usb_endpoint_config_table[NUM_ENDPOINTS] = {0};
+
+// Packet memory, normally in usb_mem.c
+
+static usb_packet_t pool[NUM_USB_BUFFERS];
+static uint8_t pool_used[NUM_USB_BUFFERS];
+
+uint32_t millis(void) { return systick_millis_count; }
+void yield(void) {}
+void usb_init_serialnumber(void) {}
+
+usb_packet_t * usb_malloc(void)
+{
+	for (int i = 0; i < NUM_USB_BUFFERS; i++) {
+		if (pool_used[i]) continue;
+		pool_used[i] = 1;
+		memset(&pool[i], 0, sizeof(pool[i]));
+		return &pool[i];
+	}
+	return NULL;
+}
+
+void usb_free(usb_packet_t *packet)
+{
+	pool_used[packet - pool] = 0;
+}
+
+static void systick_isr(void)
+{
+	systick_millis_count++;
+}
+
+static void interrupt(uint8_t status)
+{
+	usb0_istat_raised = status;
+	usb_isr();
+}
+
+// The host takes the report in the transmit buffer, if there is one
+static void poll(void)
+{
+	for (int odd = EVEN; odd <= ODD; odd++) {
+		bdt_t *b = &table[index(XINPUT_TX_ENDPOINT, TX, odd)];
+		if (!(b->desc & BDT_OWN)) continue;
+		b->desc &= ~BDT_OWN;
+		USB0_STAT = (XINPUT_TX_ENDPOINT << 4) | (TX << 3) | (odd << 2);
+		interrupt(USB_ISTAT_TOKDNE);
+		reports++;
+		return;
+	}
+}
+
+// One millisecond: the systick, the host, and a report from the sketch
+static void tick(void)
+{
+	static const uint8_t report[XINPUT_TX_SIZE] = { 0x00, XINPUT_TX_SIZE };
+
+	_VectorsRam[USB_SYSTICK_VECTOR]();
+	const uint32_t now = millis();
+	if (resume_at && now == resume_at) {
+		resume_at = 0;
+		interrupt(USB_ISTAT_RESUME);
+		frames = 1;
+		poll_at = now + RecoveryMs;
+	}
+	if (poll_at && now == poll_at) {
+		poll_at = 0;
+		polling = 1;
+	}
+	if (frames) interrupt(USB_ISTAT_SOFTOK);
+	if (polling) poll();
+	if (usb_tx_packet_count(XINPUT_TX_ENDPOINT) == 0) usb_xinput_send(report, sizeof(report));
+}
+
+static void run(uint32_t ms)
+{
+	while (ms--) tick();
+}
+
+int main(void)
+{
+	_VectorsRam[USB_SYSTICK_VECTOR] = systick_isr;
+
+	// Enumerated, and the host enabled remote wakeup (SET_FEATURE)
+	usb_configuration = 1;
+	usb_set_state(USB_STATE_CONFIGURED);
+	usb_remote_wakeup_enabled = 1;
+	run(50);
+	CHECK(reports >= 49);
+
+	// Host suspends the bus. The device sees it after 3 ms idle.
+	frames = polling = 0;
+	run(3);
+	interrupt(USB_ISTAT_SLEEP);
+	CHECK(usb_suspended);
+	CHECK_EQ(usb_state, USB_STATE_SUSPENDED);
+	CHECK(USB0_USBCTRL & USB_USBCTRL_SUSP);
+	const uint32_t suspended = millis();
+
+	// A press right away. The K state waits for 5 ms of idle bus.
+	run(1);
+	const uint32_t pressed = millis();
+	CHECK(usb_xinput_wakeup());
+	CHECK(!usb_xinput_wakeup());  // once per suspend
+	CHECK(_VectorsRam[USB_SYSTICK_VECTOR] == usb_systick_timer);
+
+	uint32_t k_begin = 0, k_end = 0;
+	while (!k_end && millis() < pressed + 100) {
+		run(1);
+		if (!k_begin && (USB0_CTL & USB_CTL_RESUME)) {
+			k_begin = millis();
+			resume_at = k_begin + ResumeMs;  // host takes over the resume
+		}
+		if (k_begin && !k_end && !(USB0_CTL & USB_CTL_RESUME)) k_end = millis();
+	}
+	CHECK_EQ(k_begin, suspended + 3);
+	CHECK(!(USB0_USBCTRL & USB_USBCTRL_SUSP));
+	CHECK(k_end - k_begin >= 1 && k_end - k_begin <= 15);  // 7.1.7.7, TDRSMUP
+	CHECK_EQ(k_end - k_begin, 5);
+	CHECK(_VectorsRam[USB_SYSTICK_VECTOR] == systick_isr);  // unchained
+
+	// Host resumes, recovers and polls. The first report it takes ends the timing.
+	run(ResumeMs + RecoveryMs + 5);
+	CHECK(!usb_suspended);
+	CHECK_EQ(usb_state, USB_STATE_CONFIGURED);
+	const uint32_t woken = usb_xinput_wakeup_time();
+	CHECK(woken > 0);
+	CHECK(woken <= BudgetMs);
+
+	printf("wakeup %u ms from the press to the first report (budget %u ms, host resume %u ms + recovery %u ms)\n",
+		(unsigned) woken, (unsigned) BudgetMs, (unsigned) ResumeMs, (unsigned) RecoveryMs);
+	return checkResult("wakeup");
+}
@@ -0,0 +1,128 @@
+/*
+ *  Project     Arduino XInput Library
+ *  @author     David Madison
+ *  @link       github.com/dmadison/ArduinoXInput
+ *  @license    MIT - Copyright (c) 2019 David Madison
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+// Stall watchdog in the core (usb_xinput.c), against a model host polling
+// once per frame: a stall the flush clears, and one that takes a reconnect
+// and a new enumeration. Prints the recovery time the core measures.
+
+#define USB_XINPUT
+#include "usb_xinput.c"
+#include "check.h"
+
+// Model host. The device queues a report every frame. The host takes it
+// while polling, and enumerates again 'EnumMs' after seeing a disconnect.
+static const uint32_t EnumMs = 100;  // Typical of a desktop host, varies
+
+static uint32_t now_ms;
+static int polling = 1;
+static int queued = 0;
+static int flushes = 0, reconnects = 0;
+static uint32_t reconnect_at = 0;  // ms the host has enumerated again, 0 if attached
+
+// Core state, normally in usb_dev.c
+volatile uint8_t usb_configuration = 1;
+volatile uint32_t usb_sof_count = 0;
+volatile uint8_t usb_suspended = 0;
+volatile uint8_t usb_state = USB_STATE_CONFIGURED;
+volatile uint32_t usb_state_millis[USB_STATE_COUNT];
+volatile uint32_t usb_tx_frame[NUM_ENDPOINTS];
+uint16_t usb_rx_byte_count_data[NUM_ENDPOINTS];
+
+uint32_t millis(void) { return now_ms; }
+void yield(void) {}
+usb_packet_t * usb_malloc(void) { return NULL; }
+void usb_free(usb_packet_t *packet) { (void) packet; }
+usb_packet_t * usb_rx(uint32_t endpoint) { (void) endpoint; return NULL; }
+uint32_t usb_tx_packet_count(uint32_t endpoint) { (void) endpoint; return queued; }
+void usb_tx(uint32_t endpoint, usb_packet_t *packet) { (void) endpoint; (void) packet; }
+uint32_t usb_tx_busy(uint32_t endpoint) { (void) endpoint; return queued; }
+void usb_tx_discard(uint32_t endpoint) { (void) endpoint; queued = 0; flushes++; }
+int usb_remote_wakeup(void) { return 0; }
+
+void usb_soft_reconnect(uint32_t ms)
+{
+	reconnects++;
+	usb_configuration = 0;
+	usb_state = USB_STATE_POWERED;
+	queued = 0;
+	reconnect_at = now_ms + ms + EnumMs;
+}
+
+// One millisecond: a frame if configured, with the host polling if it is
+static void tick(void)
+{
+	now_ms++;
+	if (reconnect_at && now_ms >= reconnect_at) {
+		reconnect_at = 0;
+		usb_configuration = 1;
+		usb_state = USB_STATE_CONFIGURED;
+		memset((void *) usb_tx_frame, 0, sizeof(usb_tx_frame));  // as on SET_CONFIGURATION
+		polling = 1;
+	}
+	if (!usb_configuration) return;  // no frames
+
+	usb_sof_count++;
+	queued = 1;  // a report every frame
+	if (polling) {
+		usb_tx_frame[tx_endpoint[0] - 1] = usb_sof_count;
+		queued = 0;
+	}
+	usb_xinput_watchdog();
+}
+
+static void run(uint32_t ms)
+{
+	while (ms--) tick();
+}
+
+int main(void)
+{
+	static const uint16_t FlushMs = 20, ReconnectMs = 100;
+	usb_xinput_watchdog_set(FlushMs, ReconnectMs);
+	run(50);
+
+	// Host stops polling for 60 ms, the flush fires, then it comes back
+	polling = 0;
+	run(60);
+	polling = 1;
+	run(10);
+	CHECK_EQ(flushes, 1);
+	CHECK_EQ(reconnects, 0);
+	const uint32_t flushed = usb_xinput_recovery_time();
+	CHECK_EQ(flushed, 60 - FlushMs);  // From the flush to the first report after it
+
+	// Host stops for good, until a reconnect
+	polling = 0;
+	run(FlushMs + ReconnectMs + WATCHDOG_DISCONNECT_MS + EnumMs + 20);
+	CHECK_EQ(flushes, 2);
+	CHECK_EQ(reconnects, 1);
+	const uint32_t reconnected = usb_xinput_recovery_time();
+	CHECK_EQ(reconnected, ReconnectMs + WATCHDOG_DISCONNECT_MS + EnumMs);
+
+	printf("flush %u ms, reconnect %u ms: back %u ms after a flush, %u ms after a reconnect (host enumerating in %u ms)\n",
+		FlushMs, ReconnectMs, (unsigned) flushed, (unsigned) reconnected, (unsigned) EnumMs);
+	return checkResult("watchdog");
+}
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+#
+#  Project     Arduino XInput Library
+#  @author     David Madison
+#  @link       github.com/dmadison/ArduinoXInput
+#  @license    MIT - Copyright (c) 2019 David Madison
+#
+#  Host side of XInputConfigChannel (XInputConfig.h), for retuning a
+#  controller without reflashing it. Requires pyusb.
+#
+#    python3 xinput_config.py info
+#    python3 xinput_config.py range 1             (read control 1)
+#    python3 xinput_config.py range 1 0 1023      (write control 1)
+#    python3 xinput_config.py shaping 1 100 950 50 2
+#    python3 xinput_config.py profile 2
+#    python3 xinput_config.py telemetry
+#
+
+import argparse
+import struct
+import sys
+import time
+
+import usb.core
+
+VID = 0x045E  # Set these to the VENDOR_ID / PRODUCT_ID in usb_desc.h
+PID = 0x028E
+
+INFO = 0x0100
+RANGE = 0x0101
+SHAPING = 0x0102
+PROFILE = 0x0103
+TELEMETRY = 0x0104
+
+OS_STRING_INDEX = 0xEE  # Holds the vendor code (bRequest) at byte 16
+
+
+class XInputConfig:
+	def __init__(self, vid=VID, pid=PID):
+		self.dev = usb.core.find(idVendor=vid, idProduct=pid)
+		if self.dev is None:
+			raise IOError("controller not found")
+		os_string = self.dev.ctrl_transfer(0x80, 0x06, 0x0300 | OS_STRING_INDEX, 0, 0x12)
+		self.vendor_code = os_string[16]
+
+	def read(self, command, value=0, length=64):
+		return bytes(self.dev.ctrl_transfer(0xC0, self.vendor_code, value, command, length))
+
+	def write(self, command, value=0, data=b""):
+		# A stall means the last write hasn't been applied yet, or bad arguments
+		for _ in range(3):
+			try:
+				self.dev.ctrl_transfer(0x40, self.vendor_code, value, command, data)
+				time.sleep(0.02)  # Writes are applied from the sketch's loop()
+				return
+			except usb.core.USBError as e:
+				if e.errno != 32:  # EPIPE (stall)
+					raise
+				error = e
+				time.sleep(0.02)
+		raise error
+
+	def info(self):
+		version, interfaces, profiles, profile = struct.unpack("<4B", self.read(INFO, length=4))
+		return {"version": version, "interfaces": interfaces, "profiles": profiles, "profile": profile}
+
+	def get_range(self, control):
+		return struct.unpack("<ii", self.read(RANGE, control, 8))
+
+	def set_range(self, control, lo, hi):
+		self.write(RANGE, control, struct.pack("<ii", lo, hi))
+
+	def get_shaping(self, control):
+		return struct.unpack("<HHHB", self.read(SHAPING, control, 7))
+
+	def set_shaping(self, control, inner, outer, anti, curve):
+		self.write(SHAPING, control, struct.pack("<HHHB", inner, outer, anti, curve))
+
+	def get_profile(self):
+		return struct.unpack("<BB", self.read(PROFILE, length=2))
+
+	def set_profile(self, index):
+		self.write(PROFILE, index)
+
+	def telemetry(self):
+		frame = self.read(TELEMETRY, length=64)  # XInputTelemetry frame
+		return frame.hex()
+
+
+def main():
+	parser = argparse.ArgumentParser(description="XInput live configuration")
+	parser.add_argument("command", choices=["info", "range", "shaping", "profile", "telemetry"])
+	parser.add_argument("args", nargs="*", type=int)
+	parser.add_argument("--vid", type=lambda x: int(x, 0), default=VID)
+	parser.add_argument("--pid", type=lambda x: int(x, 0), default=PID)
+	opts = parser.parse_args()
+
+	cfg = XInputConfig(opts.vid, opts.pid)
+	a = opts.args
+
+	if opts.command == "info":
+		print(cfg.info())
+	elif opts.command == "range":
+		if len(a) == 3:
+			cfg.set_range(*a)
+		print(cfg.get_range(a[0]))
+	elif opts.command == "shaping":
+		if len(a) == 5:
+			cfg.set_shaping(*a)
+		print(cfg.get_shaping(a[0]))
+	elif opts.command == "profile":
+		if a:
+			cfg.set_profile(a[0])
+		print(cfg.get_profile())
+	elif opts.command == "telemetry":
+		print(cfg.telemetry())
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+#
+#  Project     Arduino XInput Library
+#  @author     David Madison
+#  @link       github.com/dmadison/ArduinoXInput
+#  @license    MIT - Copyright (c) 2019 David Madison
+#
+#  Reader for XInputStream (XInputStream.h) on the "XInput + WinUSB" USB
+#  type. Prints throughput and decodes telemetry frames. Requires pyusb.
+#
+#    python3 xinput_stream.py             (throughput, once a second)
+#    python3 xinput_stream.py --frames    (decoded telemetry)
+#
+
+import argparse
+import struct
+import sys
+import time
+
+import usb.core
+import usb.util
+
+VID = 0x045E  # Set these to the VENDOR_ID / PRODUCT_ID in usb_desc.h
+PID = 0x0000
+
+BULK_INTERFACE = 1  # XINPUT_BULK_INTERFACE
+BULK_IN = 0x83      # XINPUT_BULK_TX_ENDPOINT | 0x80
+READ_SIZE = 64 * 64  # Several packets per request keeps the bus busy
+
+# XInputTelemetry.h frame: sync, length, 32-byte payload, XOR checksum
+SYNC = b"\x58\xA5"
+PAYLOAD_SIZE = 32
+FRAME_SIZE = 2 + 1 + PAYLOAD_SIZE + 1
+
+
+def decode(buf):
+	"""Yields telemetry payloads from 'buf' (a bytearray), consuming them."""
+	while True:
+		start = buf.find(SYNC)
+		if start < 0:
+			del buf[:max(len(buf) - 1, 0)]
+			return
+		del buf[:start]
+		if len(buf) < FRAME_SIZE:
+			return
+		payload = bytes(buf[3:3 + PAYLOAD_SIZE])
+		checksum = 0
+		for b in payload:
+			checksum ^= b
+		if buf[2] != PAYLOAD_SIZE or checksum != buf[FRAME_SIZE - 1]:
+			del buf[:1]  # False sync
+			continue
+		del buf[:FRAME_SIZE]
+		yield payload
+
+
+def main():
+	parser = argparse.ArgumentParser(description="XInput bulk diagnostics reader")
+	parser.add_argument("--frames", action="store_true", help="print decoded telemetry")
+	parser.add_argument("--vid", type=lambda x: int(x, 0), default=VID)
+	parser.add_argument("--pid", type=lambda x: int(x, 0), default=PID)
+	opts = parser.parse_args()
+
+	dev = usb.core.find(idVendor=opts.vid, idProduct=opts.pid)
+	if dev is None:
+		print("controller not found", file=sys.stderr)
+		return 1
+	usb.util.claim_interface(dev, BULK_INTERFACE)
+
+	buf = bytearray()
+	total = frames = 0
+	mark = time.monotonic()
+	while True:
+		try:
+			data = dev.read(BULK_IN, READ_SIZE, timeout=1000)
+		except usb.core.USBTimeoutError:
+			data = b""
+		total += len(data)
+		buf += data
+
+		for payload in decode(buf):
+			frames += 1
+			if opts.frames:
+				report = payload[:20]
+				frame, last, worst = struct.unpack_from("<IHH", payload, 24)
+				print("frame %10d  send %5d us (max %5d)  report %s" % (frame, last, worst, report.hex()))
+
+		now = time.monotonic()
+		if not opts.frames and now - mark >= 1.0:
+			print("%8.1f KB/s  %6d frames/s" % (total / (now - mark) / 1000, frames / (now - mark)))
+			total = frames = 0
+			mark = now
+
+
+if __name__ == "__main__":
+	sys.exit(main())
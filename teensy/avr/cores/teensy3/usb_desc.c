@@ -171,6 +171,39 @@ static uint8_t keyboard_report_desc[] = {
 };
 #endif
 
+#ifdef KEYBOARD_NKRO_INTERFACE
+// N-key rollover: modifiers, then one bit per key code, so any number of
+// keys can be held. Not boot compatible, a BIOS won't see this keyboard.
+static uint8_t keyboard_nkro_report_desc[] = {
+        0x05, 0x01,                     // Usage Page (Generic Desktop),
+        0x09, 0x06,                     // Usage (Keyboard),
+        0xA1, 0x01,                     // Collection (Application),
+        0x75, 0x01,                     //   Report Size (1),
+        0x95, 0x08,                     //   Report Count (8),
+        0x05, 0x07,                     //   Usage Page (Key Codes),
+        0x19, 0xE0,                     //   Usage Minimum (224),
+        0x29, 0xE7,                     //   Usage Maximum (231),
+        0x15, 0x00,                     //   Logical Minimum (0),
+        0x25, 0x01,                     //   Logical Maximum (1),
+        0x81, 0x02,                     //   Input (Data, Variable, Absolute), ;Modifier keys
+        0x95, 0x05,                     //   Report Count (5),
+        0x05, 0x08,                     //   Usage Page (LEDs),
+        0x19, 0x01,                     //   Usage Minimum (1),
+        0x29, 0x05,                     //   Usage Maximum (5),
+        0x91, 0x02,                     //   Output (Data, Variable, Absolute), ;LED report
+        0x95, 0x01,                     //   Report Count (1),
+        0x75, 0x03,                     //   Report Size (3),
+        0x91, 0x03,                     //   Output (Constant),         ;LED report padding
+        0x95, 0x78,                     //   Report Count (120),
+        0x75, 0x01,                     //   Report Size (1),
+        0x05, 0x07,                     //   Usage Page (Key Codes),
+        0x19, 0x00,                     //   Usage Minimum (0),
+        0x29, 0x77,                     //   Usage Maximum (119),
+        0x81, 0x02,                     //   Input (Data, Variable, Absolute), ;Key bitmap
+        0xC0                            // End Collection
+};
+#endif
+
 #ifdef KEYMEDIA_INTERFACE
 static uint8_t keymedia_report_desc[] = {
         0x05, 0x0C,                     // Usage Page (Consumer)
@@ -243,6 +276,45 @@ static uint8_t mouse_report_desc[] = {
 };
 #endif
 
+#ifdef MOUSE_HIRES_INTERFACE
+// Relative mouse with 16-bit X/Y, so fast stick motion isn't clamped to 127 a frame
+static uint8_t mouse_hires_report_desc[] = {
+        0x05, 0x01,                     // Usage Page (Generic Desktop)
+        0x09, 0x02,                     // Usage (Mouse)
+        0xA1, 0x01,                     // Collection (Application)
+        0x09, 0x01,                     //   Usage (Pointer)
+        0xA1, 0x00,                     //   Collection (Physical)
+        0x05, 0x09,                     //     Usage Page (Button)
+        0x19, 0x01,                     //     Usage Minimum (Button #1)
+        0x29, 0x08,                     //     Usage Maximum (Button #8)
+        0x15, 0x00,                     //     Logical Minimum (0)
+        0x25, 0x01,                     //     Logical Maximum (1)
+        0x95, 0x08,                     //     Report Count (8)
+        0x75, 0x01,                     //     Report Size (1)
+        0x81, 0x02,                     //     Input (Data, Variable, Absolute)
+        0x05, 0x01,                     //     Usage Page (Generic Desktop)
+        0x09, 0x30,                     //     Usage (X)
+        0x09, 0x31,                     //     Usage (Y)
+        0x16, 0x01, 0x80,               //     Logical Minimum (-32767)
+        0x26, 0xFF, 0x7F,               //     Logical Maximum (32767)
+        0x75, 0x10,                     //     Report Size (16),
+        0x95, 0x02,                     //     Report Count (2),
+        0x81, 0x06,                     //     Input (Data, Variable, Relative)
+        0x09, 0x38,                     //     Usage (Wheel)
+        0x15, 0x81,                     //     Logical Minimum (-127)
+        0x25, 0x7F,                     //     Logical Maximum (127)
+        0x75, 0x08,                     //     Report Size (8),
+        0x95, 0x01,                     //     Report Count (1),
+        0x81, 0x06,                     //     Input (Data, Variable, Relative)
+        0x05, 0x0C,                     //     Usage Page (Consumer)
+        0x0A, 0x38, 0x02,               //     Usage (AC Pan)
+        0x95, 0x01,                     //     Report Count (1),
+        0x81, 0x06,                     //     Input (Data, Variable, Relative)
+        0xC0,                           //   End Collection
+        0xC0                            // End Collection
+};
+#endif
+
 #ifdef JOYSTICK_INTERFACE
 #if JOYSTICK_SIZE == 12
 static uint8_t joystick_report_desc[] = {
@@ -489,7 +561,35 @@ static uint8_t flightsim_report_desc[] = {
 #define XINPUT_INTERFACE_DESC_SIZE      0
 #endif     
 
-#define CDC_IAD_DESCRIPTOR_POS		XINPUT_INTERFACE_DESC_POS+XINPUT_INTERFACE_DESC_SIZE
+#define XINPUT2_INTERFACE_DESC_POS  XINPUT_INTERFACE_DESC_POS+XINPUT_INTERFACE_DESC_SIZE
+#ifdef XINPUT2_INTERFACE
+#define XINPUT2_INTERFACE_DESC_SIZE     9+17+7+7
+#else
+#define XINPUT2_INTERFACE_DESC_SIZE     0
+#endif
+
+#define XINPUT3_INTERFACE_DESC_POS  XINPUT2_INTERFACE_DESC_POS+XINPUT2_INTERFACE_DESC_SIZE
+#ifdef XINPUT3_INTERFACE
+#define XINPUT3_INTERFACE_DESC_SIZE     9+17+7+7
+#else
+#define XINPUT3_INTERFACE_DESC_SIZE     0
+#endif
+
+#define XINPUT4_INTERFACE_DESC_POS  XINPUT3_INTERFACE_DESC_POS+XINPUT3_INTERFACE_DESC_SIZE
+#ifdef XINPUT4_INTERFACE
+#define XINPUT4_INTERFACE_DESC_SIZE     9+17+7+7
+#else
+#define XINPUT4_INTERFACE_DESC_SIZE     0
+#endif
+
+#define XINPUT_BULK_INTERFACE_DESC_POS  XINPUT4_INTERFACE_DESC_POS+XINPUT4_INTERFACE_DESC_SIZE
+#ifdef XINPUT_BULK_INTERFACE
+#define XINPUT_BULK_INTERFACE_DESC_SIZE 9+7+7
+#else
+#define XINPUT_BULK_INTERFACE_DESC_SIZE 0
+#endif
+
+#define CDC_IAD_DESCRIPTOR_POS		XINPUT_BULK_INTERFACE_DESC_POS+XINPUT_BULK_INTERFACE_DESC_SIZE
 #ifdef  CDC_IAD_DESCRIPTOR
 #define CDC_IAD_DESCRIPTOR_SIZE		8
 #else
@@ -535,7 +635,15 @@ static uint8_t flightsim_report_desc[] = {
 #define KEYBOARD_INTERFACE_DESC_SIZE	0
 #endif
 
-#define MOUSE_INTERFACE_DESC_POS	KEYBOARD_INTERFACE_DESC_POS+KEYBOARD_INTERFACE_DESC_SIZE
+#define KEYBOARD_NKRO_INTERFACE_DESC_POS	KEYBOARD_INTERFACE_DESC_POS+KEYBOARD_INTERFACE_DESC_SIZE
+#ifdef  KEYBOARD_NKRO_INTERFACE
+#define KEYBOARD_NKRO_INTERFACE_DESC_SIZE	9+9+7
+#define KEYBOARD_NKRO_HID_DESC_OFFSET	KEYBOARD_NKRO_INTERFACE_DESC_POS+9
+#else
+#define KEYBOARD_NKRO_INTERFACE_DESC_SIZE	0
+#endif
+
+#define MOUSE_INTERFACE_DESC_POS	KEYBOARD_NKRO_INTERFACE_DESC_POS+KEYBOARD_NKRO_INTERFACE_DESC_SIZE
 #ifdef  MOUSE_INTERFACE
 #define MOUSE_INTERFACE_DESC_SIZE	9+9+7
 #define MOUSE_HID_DESC_OFFSET		MOUSE_INTERFACE_DESC_POS+9
@@ -543,7 +651,15 @@ static uint8_t flightsim_report_desc[] = {
 #define MOUSE_INTERFACE_DESC_SIZE	0
 #endif
 
-#define RAWHID_INTERFACE_DESC_POS	MOUSE_INTERFACE_DESC_POS+MOUSE_INTERFACE_DESC_SIZE
+#define MOUSE_HIRES_INTERFACE_DESC_POS	MOUSE_INTERFACE_DESC_POS+MOUSE_INTERFACE_DESC_SIZE
+#ifdef  MOUSE_HIRES_INTERFACE
+#define MOUSE_HIRES_INTERFACE_DESC_SIZE	9+9+7
+#define MOUSE_HIRES_HID_DESC_OFFSET	MOUSE_HIRES_INTERFACE_DESC_POS+9
+#else
+#define MOUSE_HIRES_INTERFACE_DESC_SIZE	0
+#endif
+
+#define RAWHID_INTERFACE_DESC_POS	MOUSE_HIRES_INTERFACE_DESC_POS+MOUSE_HIRES_INTERFACE_DESC_SIZE
 #ifdef  RAWHID_INTERFACE
 #define RAWHID_INTERFACE_DESC_SIZE	9+9+7+7
 #define RAWHID_HID_DESC_OFFSET		RAWHID_INTERFACE_DESC_POS+9
@@ -671,6 +787,120 @@ static uint8_t config_descriptor[CONFIG_DESC_SIZE] = {
         // Other interfaces originally defined in ArduinoXInput_Teensy are not necessary
 #endif // XINPUT_INTERFACE
 
+#ifdef XINPUT2_INTERFACE
+        // Interface 1, same layout as interface 0 with its own endpoints
+        9,                                      // bLength
+        4,                                      // bDescriptorType
+        XINPUT2_INTERFACE,                      // bInterfaceNumber
+        0,                                      // bAlternateSetting
+        2,                                      // bNumEndpoints
+        0xFF,                                   // bInterfaceClass (Vendor Defined is 255)
+        0x5D,                                   // bInterfaceSubClass
+        0x01,                                   // bInterfaceProtocol
+        0,                                      // iInterface
+        // Common descriptor, with this interface's IN and OUT endpoint addresses
+        17,33,0,1,1,37,XINPUT2_TX_ENDPOINT | 0x80,20,0,0,0,0,19,XINPUT2_RX_ENDPOINT,8,0,0,
+        // Endpoint IN
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT2_TX_ENDPOINT | 0x80,             // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03 is interrupt no synch, usage type data)
+        0x20, 0x00,                             // wMaxPacketSize
+        1,                                      // bInterval
+        // Endpoint OUT
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT2_RX_ENDPOINT,                    // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03 is interrupt no synch, usage type data)
+        0x20, 0x00,                             // wMaxPacketSize
+        8,                                      // bInterval
+#endif // XINPUT2_INTERFACE
+
+#ifdef XINPUT3_INTERFACE
+        // Interface 2, same layout as interface 0 with its own endpoints
+        9,                                      // bLength
+        4,                                      // bDescriptorType
+        XINPUT3_INTERFACE,                      // bInterfaceNumber
+        0,                                      // bAlternateSetting
+        2,                                      // bNumEndpoints
+        0xFF,                                   // bInterfaceClass (Vendor Defined is 255)
+        0x5D,                                   // bInterfaceSubClass
+        0x01,                                   // bInterfaceProtocol
+        0,                                      // iInterface
+        // Common descriptor, with this interface's IN and OUT endpoint addresses
+        17,33,0,1,1,37,XINPUT3_TX_ENDPOINT | 0x80,20,0,0,0,0,19,XINPUT3_RX_ENDPOINT,8,0,0,
+        // Endpoint IN
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT3_TX_ENDPOINT | 0x80,             // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03 is interrupt no synch, usage type data)
+        0x20, 0x00,                             // wMaxPacketSize
+        1,                                      // bInterval
+        // Endpoint OUT
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT3_RX_ENDPOINT,                    // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03 is interrupt no synch, usage type data)
+        0x20, 0x00,                             // wMaxPacketSize
+        8,                                      // bInterval
+#endif // XINPUT3_INTERFACE
+
+#ifdef XINPUT4_INTERFACE
+        // Interface 3, same layout as interface 0 with its own endpoints
+        9,                                      // bLength
+        4,                                      // bDescriptorType
+        XINPUT4_INTERFACE,                      // bInterfaceNumber
+        0,                                      // bAlternateSetting
+        2,                                      // bNumEndpoints
+        0xFF,                                   // bInterfaceClass (Vendor Defined is 255)
+        0x5D,                                   // bInterfaceSubClass
+        0x01,                                   // bInterfaceProtocol
+        0,                                      // iInterface
+        // Common descriptor, with this interface's IN and OUT endpoint addresses
+        17,33,0,1,1,37,XINPUT4_TX_ENDPOINT | 0x80,20,0,0,0,0,19,XINPUT4_RX_ENDPOINT,8,0,0,
+        // Endpoint IN
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT4_TX_ENDPOINT | 0x80,             // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03 is interrupt no synch, usage type data)
+        0x20, 0x00,                             // wMaxPacketSize
+        1,                                      // bInterval
+        // Endpoint OUT
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT4_RX_ENDPOINT,                    // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03 is interrupt no synch, usage type data)
+        0x20, 0x00,                             // wMaxPacketSize
+        8,                                      // bInterval
+#endif // XINPUT4_INTERFACE
+
+#ifdef XINPUT_BULK_INTERFACE
+        // Vendor bulk interface, no class driver. WinUSB binds to it through the compat ID
+        9,                                      // bLength
+        4,                                      // bDescriptorType
+        XINPUT_BULK_INTERFACE,                  // bInterfaceNumber
+        0,                                      // bAlternateSetting
+        2,                                      // bNumEndpoints
+        0xFF,                                   // bInterfaceClass (Vendor Defined is 255)
+        0x00,                                   // bInterfaceSubClass
+        0x00,                                   // bInterfaceProtocol
+        0,                                      // iInterface
+        // Endpoint IN
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT_BULK_TX_ENDPOINT | 0x80,         // bEndpointAddress
+        0x02,                                   // bmAttributes (0x02 is bulk)
+        XINPUT_BULK_TX_SIZE, 0,                 // wMaxPacketSize
+        0,                                      // bInterval (ignored for bulk)
+        // Endpoint OUT
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        XINPUT_BULK_RX_ENDPOINT,                // bEndpointAddress
+        0x02,                                   // bmAttributes (0x02 is bulk)
+        XINPUT_BULK_RX_SIZE, 0,                 // wMaxPacketSize
+        0,                                      // bInterval (ignored for bulk)
+#endif // XINPUT_BULK_INTERFACE
+
 #ifdef CDC_IAD_DESCRIPTOR
         // interface association descriptor, USB ECN, Table 9-Z
         8,                                      // bLength
@@ -704,7 +934,7 @@ static uint8_t config_descriptor[CONFIG_DESC_SIZE] = {
         0x24,                                   // bDescriptorType
         0x01,                                   // bDescriptorSubtype
         0x01,                                   // bmCapabilities
-        1,                                      // bDataInterface
+        CDC_DATA_INTERFACE,                     // bDataInterface
         // Abstract Control Management Functional Descriptor, CDC Spec 5.2.3.3, Table 28
         4,                                      // bFunctionLength
         0x24,                                   // bDescriptorType
@@ -1152,6 +1382,35 @@ static uint8_t config_descriptor[CONFIG_DESC_SIZE] = {
         KEYBOARD_INTERVAL,                      // bInterval
 #endif // KEYBOARD_INTERFACE
 
+#ifdef KEYBOARD_NKRO_INTERFACE
+        // interface descriptor, USB spec 9.6.5, page 267-269, Table 9-12
+        9,                                      // bLength
+        4,                                      // bDescriptorType
+        KEYBOARD_NKRO_INTERFACE,                // bInterfaceNumber
+        0,                                      // bAlternateSetting
+        1,                                      // bNumEndpoints
+        0x03,                                   // bInterfaceClass (0x03 = HID)
+        0x00,                                   // bInterfaceSubClass (not boot, the report is a bitmap)
+        0x00,                                   // bInterfaceProtocol
+        0,                                      // iInterface
+        // HID interface descriptor, HID 1.11 spec, section 6.2.1
+        9,                                      // bLength
+        0x21,                                   // bDescriptorType
+        0x11, 0x01,                             // bcdHID
+        0,                                      // bCountryCode
+        1,                                      // bNumDescriptors
+        0x22,                                   // bDescriptorType
+        LSB(sizeof(keyboard_nkro_report_desc)), // wDescriptorLength
+        MSB(sizeof(keyboard_nkro_report_desc)),
+        // endpoint descriptor, USB spec 9.6.6, page 269-271, Table 9-13
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        KEYBOARD_NKRO_ENDPOINT | 0x80,          // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03=intr)
+        KEYBOARD_NKRO_SIZE, 0,                  // wMaxPacketSize
+        KEYBOARD_NKRO_INTERVAL,                 // bInterval
+#endif // KEYBOARD_NKRO_INTERFACE
+
 #ifdef MOUSE_INTERFACE
         // interface descriptor, USB spec 9.6.5, page 267-269, Table 9-12
         9,                                      // bLength
@@ -1181,6 +1440,35 @@ static uint8_t config_descriptor[CONFIG_DESC_SIZE] = {
         MOUSE_INTERVAL,                         // bInterval
 #endif // MOUSE_INTERFACE
 
+#ifdef MOUSE_HIRES_INTERFACE
+        // interface descriptor, USB spec 9.6.5, page 267-269, Table 9-12
+        9,                                      // bLength
+        4,                                      // bDescriptorType
+        MOUSE_HIRES_INTERFACE,                  // bInterfaceNumber
+        0,                                      // bAlternateSetting
+        1,                                      // bNumEndpoints
+        0x03,                                   // bInterfaceClass (0x03 = HID)
+        0x00,                                   // bInterfaceSubClass (not boot, 16-bit deltas)
+        0x00,                                   // bInterfaceProtocol
+        0,                                      // iInterface
+        // HID interface descriptor, HID 1.11 spec, section 6.2.1
+        9,                                      // bLength
+        0x21,                                   // bDescriptorType
+        0x11, 0x01,                             // bcdHID
+        0,                                      // bCountryCode
+        1,                                      // bNumDescriptors
+        0x22,                                   // bDescriptorType
+        LSB(sizeof(mouse_hires_report_desc)),   // wDescriptorLength
+        MSB(sizeof(mouse_hires_report_desc)),
+        // endpoint descriptor, USB spec 9.6.6, page 269-271, Table 9-13
+        7,                                      // bLength
+        5,                                      // bDescriptorType
+        MOUSE_HIRES_ENDPOINT | 0x80,            // bEndpointAddress
+        0x03,                                   // bmAttributes (0x03=intr)
+        MOUSE_HIRES_SIZE, 0,                    // wMaxPacketSize
+        MOUSE_HIRES_INTERVAL,                   // bInterval
+#endif // MOUSE_HIRES_INTERFACE
+
 #ifdef RAWHID_INTERFACE
         // interface descriptor, USB spec 9.6.5, page 267-269, Table 9-12
         9,                                      // bLength
@@ -1715,6 +2003,42 @@ const usb_extended_compat_id_descriptor usb_extended_compat_id_desc = {
             .subCompatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
             .bRESERVED1 = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
         },
+        #if defined(XINPUT2_INTERFACE)
+        {
+            .bFirstInterfaceNumber = XINPUT2_INTERFACE,
+            .bRESERVED0 = 0x01,
+            .compatibleID = {0x58, 0x55, 0x53, 0x42, 0x31, 0x30, 0x00, 0x00}, // XUSB10
+            .subCompatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+            .bRESERVED1 = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+        },
+        #endif
+        #if defined(XINPUT3_INTERFACE)
+        {
+            .bFirstInterfaceNumber = XINPUT3_INTERFACE,
+            .bRESERVED0 = 0x01,
+            .compatibleID = {0x58, 0x55, 0x53, 0x42, 0x31, 0x30, 0x00, 0x00}, // XUSB10
+            .subCompatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+            .bRESERVED1 = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+        },
+        #endif
+        #if defined(XINPUT4_INTERFACE)
+        {
+            .bFirstInterfaceNumber = XINPUT4_INTERFACE,
+            .bRESERVED0 = 0x01,
+            .compatibleID = {0x58, 0x55, 0x53, 0x42, 0x31, 0x30, 0x00, 0x00}, // XUSB10
+            .subCompatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+            .bRESERVED1 = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+        },
+        #endif
+        #if defined(XINPUT_BULK_INTERFACE)
+        {
+            .bFirstInterfaceNumber = XINPUT_BULK_INTERFACE,
+            .bRESERVED0 = 0x01,
+            .compatibleID = {0x57, 0x49, 0x4E, 0x55, 0x53, 0x42, 0x00, 0x00}, // WINUSB
+            .subCompatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+            .bRESERVED1 = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+        },
+        #endif
         #if defined(USB_XINPUT_KEYBOARD_MOUSE) // could probably change these based off NUM_INTERFACE > ##
         {
             .bFirstInterfaceNumber = 0x01,
@@ -1730,6 +2054,15 @@ const usb_extended_compat_id_descriptor usb_extended_compat_id_desc = {
             .subCompatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
             .bRESERVED1 = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
         },
+        #elif defined(CDC_IAD_DESCRIPTOR)
+        {
+            // one block for the whole IAD, no compat ID so the class driver (usbser) binds
+            .bFirstInterfaceNumber = CDC_STATUS_INTERFACE,
+            .bRESERVED0 = 0x01,
+            .compatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+            .subCompatibleID = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+            .bRESERVED1 = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+        },
         #elif defined(USB_XINPUT_SEREMU) || defined(USB_XINPUT_DIRECTINPUT) // or any 2 interface xinput usb type
         {
             .bFirstInterfaceNumber = 0x01,
@@ -1863,10 +2196,18 @@ const usb_descriptor_list_t usb_descriptor_list[] = {
         {0x2200, KEYBOARD_INTERFACE, keyboard_report_desc, sizeof(keyboard_report_desc)},
         {0x2100, KEYBOARD_INTERFACE, config_descriptor+KEYBOARD_HID_DESC_OFFSET, 9},
 #endif
+#ifdef KEYBOARD_NKRO_INTERFACE
+        {0x2200, KEYBOARD_NKRO_INTERFACE, keyboard_nkro_report_desc, sizeof(keyboard_nkro_report_desc)},
+        {0x2100, KEYBOARD_NKRO_INTERFACE, config_descriptor+KEYBOARD_NKRO_HID_DESC_OFFSET, 9},
+#endif
 #ifdef MOUSE_INTERFACE
         {0x2200, MOUSE_INTERFACE, mouse_report_desc, sizeof(mouse_report_desc)},
         {0x2100, MOUSE_INTERFACE, config_descriptor+MOUSE_HID_DESC_OFFSET, 9},
 #endif
+#ifdef MOUSE_HIRES_INTERFACE
+        {0x2200, MOUSE_HIRES_INTERFACE, mouse_hires_report_desc, sizeof(mouse_hires_report_desc)},
+        {0x2100, MOUSE_HIRES_INTERFACE, config_descriptor+MOUSE_HIRES_HID_DESC_OFFSET, 9},
+#endif
 #ifdef JOYSTICK_INTERFACE
         {0x2200, JOYSTICK_INTERFACE, joystick_report_desc, sizeof(joystick_report_desc)},
         {0x2100, JOYSTICK_INTERFACE, config_descriptor+JOYSTICK_HID_DESC_OFFSET, 9},
@@ -1905,6 +2246,69 @@ const usb_descriptor_list_t usb_descriptor_list[] = {
 };
 
 
+// **************************************************************
+//   Control Request Handlers
+// **************************************************************
+
+#if defined(OS_DESC_VERSION) && (OS_DESC_VERSION == 0x0100)
+// Microsoft OS 1.0 feature descriptor request. Only the extended compat ID
+// (wIndex 4) is supported, extended properties (wIndex 5) are not.
+static int os_desc_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen)
+{
+	*data = (const uint8_t *)&usb_extended_compat_id_desc;
+	*datalen = usb_extended_compat_id_desc.dwLength;
+	return USB_CONTROL_ACK;
+}
+#endif
+
+__attribute__((weak))
+int usb_control_user(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen)
+{
+	return USB_CONTROL_STALL;
+}
+
+__attribute__((weak))
+int usb_control_user_out(const usb_control_request_t *req, const uint8_t *buf, uint32_t len)
+{
+	return 0;
+}
+
+// This table routes class and vendor control requests to their modules.
+// Standard requests, and the class requests of modules that don't
+// register here yet, are still handled in usb_setup().
+
+const usb_control_handler_list_t usb_control_handler_list[] = {
+	//mask,  wRequestAndType,  wIndex,  handler,  out
+#if defined(OS_DESC_VERSION) && (OS_DESC_VERSION == 0x0100)
+	{0xFFFF, OS_DESC_REQANDTYPE, 0x0004, os_desc_control, NULL},
+#endif
+#if defined(XINPUT_INTERFACE) && defined(VENDOR_CODE)
+	// shares bRequest VENDOR_CODE with the OS descriptor, commands from wIndex 0x0100
+	{0xFF7F, XINPUT_CONFIG_REQANDTYPE, USB_CONTROL_ANY_INDEX, usb_xinput_config_control, usb_xinput_config_out},
+#endif
+#ifdef XINPUT_INTERFACE
+	{0xFFFF, XINPUT_CONTROL_CAPABILITIES, XINPUT_INTERFACE, usb_xinput_control, NULL},
+#endif
+#ifdef XINPUT2_INTERFACE
+	{0xFFFF, XINPUT_CONTROL_CAPABILITIES, XINPUT2_INTERFACE, usb_xinput_control, NULL},
+#endif
+#ifdef XINPUT3_INTERFACE
+	{0xFFFF, XINPUT_CONTROL_CAPABILITIES, XINPUT3_INTERFACE, usb_xinput_control, NULL},
+#endif
+#ifdef XINPUT4_INTERFACE
+	{0xFFFF, XINPUT_CONTROL_CAPABILITIES, XINPUT4_INTERFACE, usb_xinput_control, NULL},
+#endif
+#ifdef KEYBOARD_NKRO_INTERFACE
+	{0x007F, 0x0021, KEYBOARD_NKRO_INTERFACE, usb_keyboard_nkro_control, usb_keyboard_nkro_out}, // HID class, either direction
+#endif
+#ifdef MOUSE_HIRES_INTERFACE
+	{0x007F, 0x0021, MOUSE_HIRES_INTERFACE, usb_mouse_hires_control, NULL}, // HID class, either direction
+#endif
+	{0x0060, 0x0040, USB_CONTROL_ANY_INDEX, usb_control_user, usb_control_user_out}, // any vendor request
+	{0, 0, 0, NULL, NULL}
+};
+
+
 // **************************************************************
 //   Endpoint Configuration
 // **************************************************************
@@ -39,7 +39,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
-#if defined(USB_XINPUT_KEYBOARD_MOUSE) | defined(USB_XINPUT_SEREMU) | defined(USB_XINPUT_DIRECTINPUT)
+#if defined(USB_XINPUT_KEYBOARD_MOUSE) | defined(USB_XINPUT_SEREMU) | defined(USB_XINPUT_DIRECTINPUT) \
+  | defined(USB_XINPUT_X2) | defined(USB_XINPUT_X4) | defined(USB_XINPUT_WINUSB) | defined(USB_XINPUT_SERIAL)
 #include "usb_os_desc.h"
 #endif
 
@@ -992,7 +993,9 @@ The steps to add a new composite device are mostly the same as before in regards
 
 2. Add the appropriate definitions matching the patterns of existing devices
 
-3. Ensure that the XINPUT_INTERFACE is first (0) and uses endpoints 1 and 2
+3. Ensure that the XINPUT_INTERFACE is first (0) and uses endpoints 1 and 2. Additional
+    XInput interfaces (XINPUT2_INTERFACE to XINPUT4_INTERFACE) follow it directly, each
+    with its own TX/RX endpoint pair and compat ID
 
 4. Ensure that NUM_COMPAT_IDS matches the number of interfaces or independent interfaces + IADs
 
@@ -1060,21 +1063,41 @@ Computer\HKEY_LOCAL_MACHINE\SYSTEM\CurrentControlSet\Control\usbflags\VID+PID+BC
   #define XINPUT_RX_SIZE        8
   #define XINPUT_TX_ENDPOINT    1
   #define XINPUT_TX_SIZE        20
+  #ifndef KEYBOARD_NKRO
+  #define KEYBOARD_NKRO         0 // 0 = boot keyboard, 6 keys at once. 1 = N-key rollover bitmap (no BIOS support)
+  #endif
+  #if KEYBOARD_NKRO
+  #define KEYBOARD_NKRO_INTERFACE 1 // Keyboard, replaces Keyboard with usb_keyboard_nkro_class
+  #define KEYBOARD_NKRO_ENDPOINT 3
+  #define KEYBOARD_NKRO_SIZE    16 // modifiers + 120 key bits
+  #define KEYBOARD_NKRO_INTERVAL 1
+  #else
   #define KEYBOARD_INTERFACE    1 // Keyboard
   #define KEYBOARD_ENDPOINT     3
   #define KEYBOARD_SIZE         8
   #define KEYBOARD_INTERVAL     1
+  #endif
+  #ifndef MOUSE_HIRES
+  #define MOUSE_HIRES           0 // 0 = 8-bit deltas. 1 = 16-bit deltas with sub-count carry, stick mouse
+  #endif
+  #if MOUSE_HIRES
+  #define MOUSE_HIRES_INTERFACE 2 // Mouse, replaces Mouse with usb_mouse_hires_class
+  #define MOUSE_HIRES_ENDPOINT  4
+  #define MOUSE_HIRES_SIZE      7 // buttons, x, y (16 bit), wheel, pan
+  #define MOUSE_HIRES_INTERVAL  1
+  #else
   #define MOUSE_INTERFACE       2 // Mouse
   #define MOUSE_ENDPOINT        4
   #define MOUSE_SIZE            8
   #define MOUSE_INTERVAL        1
+  #endif
   #define ENDPOINT1_CONFIG ENDPOINT_TRANSMIT_ONLY
   #define ENDPOINT2_CONFIG ENDPOINT_RECEIVE_ONLY
   #define ENDPOINT3_CONFIG ENDPOINT_TRANSMIT_ONLY
   #define ENDPOINT4_CONFIG ENDPOINT_TRANSMIT_ONLY
 
 // doesn't work. I think because teensy_gateway expects seremu to use endpoint 1
-// may also need to have a teensy vendor_id (0x16C0)
+// may also need to have a teensy vendor_id (0x16C0). See USB_XINPUT_SERIAL instead
 #elif defined(USB_XINPUT_SEREMU)
   #define BCD_USB 0x0200 // usb version. technically not supported by teensyduino but works
   #define OS_DESC_VERSION 0x0100
@@ -1146,6 +1169,148 @@ Computer\HKEY_LOCAL_MACHINE\SYSTEM\CurrentControlSet\Control\usbflags\VID+PID+BC
   #define ENDPOINT2_CONFIG ENDPOINT_RECEIVE_ONLY
   #define ENDPOINT6_CONFIG ENDPOINT_TRANSMIT_ONLY
 // USB_XINPUT_DIRECTINPUT
+
+// one XInput interface per player. Each has its own endpoint pair and compat ID
+#elif defined(USB_XINPUT_X2) || defined(USB_XINPUT_X4)
+  #if defined(USB_XINPUT_X4)
+  #define XINPUT_COUNT          4
+  #define PRODUCT_ID            0x0004
+  #define PRODUCT_NAME {'X', 'I', 'n', 'p', 'u', 't', ' ', 'x', '4'}
+  #define NUM_USB_BUFFERS       32
+  #else
+  #define XINPUT_COUNT          2
+  #define PRODUCT_ID            0x0002
+  #define PRODUCT_NAME {'X', 'I', 'n', 'p', 'u', 't', ' ', 'x', '2'}
+  #define NUM_USB_BUFFERS       24
+  #endif
+  #define BCD_USB 0x0200 // usb version. technically not supported by teensyduino but works
+  #define OS_DESC_VERSION 0x0100
+  #define DEVICE_CLASS 0x00
+  #define DEVICE_SUBCLASS 0x00
+  #define DEVICE_PROTOCOL 0x00
+  #define DEVICE_ATTRIBUTES 0xA0
+  #define VENDOR_ID 0x045e
+  #define VENDOR_CODE           0xA5 // used for compat id. recommend not changing
+  #define MANUFACTURER_NAME {'T','e','e','n','s','y','d','u','i','n','o'}
+  #define MANUFACTURER_NAME_LEN 11
+  #define PRODUCT_NAME_LEN      9
+  #define EP0_SIZE              64
+  #define NUM_ENDPOINTS         (XINPUT_COUNT * 2)
+  #define NUM_INTERFACE         XINPUT_COUNT
+  #define NUM_COMPAT_IDS        XINPUT_COUNT // = num interfaces
+  #define XINPUT_INTERFACE      0 // Player 1
+  #define XINPUT_RX_ENDPOINT    2
+  #define XINPUT_RX_SIZE        8
+  #define XINPUT_TX_ENDPOINT    1
+  #define XINPUT_TX_SIZE        20
+  #define XINPUT2_INTERFACE     1 // Player 2
+  #define XINPUT2_RX_ENDPOINT   4
+  #define XINPUT2_TX_ENDPOINT   3
+  #define ENDPOINT1_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT2_CONFIG ENDPOINT_RECEIVE_ONLY
+  #define ENDPOINT3_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT4_CONFIG ENDPOINT_RECEIVE_ONLY
+  #if XINPUT_COUNT >= 4
+  #define XINPUT3_INTERFACE     2 // Player 3
+  #define XINPUT3_RX_ENDPOINT   6
+  #define XINPUT3_TX_ENDPOINT   5
+  #define XINPUT4_INTERFACE     3 // Player 4
+  #define XINPUT4_RX_ENDPOINT   8
+  #define XINPUT4_TX_ENDPOINT   7
+  #define ENDPOINT5_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT6_CONFIG ENDPOINT_RECEIVE_ONLY
+  #define ENDPOINT7_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT8_CONFIG ENDPOINT_RECEIVE_ONLY
+  #endif
+// USB_XINPUT_X2 / USB_XINPUT_X4
+
+// XInput plus a vendor bulk interface bound to WinUSB by its compat ID, for
+// streaming diagnostics. Bulk only gets the bandwidth left over after the
+// interrupt endpoints, so the XInput reports keep their 1 ms interval.
+#elif defined(USB_XINPUT_WINUSB)
+  #define BCD_USB 0x0200 // usb version. technically not supported by teensyduino but works
+  #define OS_DESC_VERSION 0x0100
+  #define DEVICE_CLASS 0x00
+  #define DEVICE_SUBCLASS 0x00
+  #define DEVICE_PROTOCOL 0x00
+  #define DEVICE_ATTRIBUTES 0xA0
+  #define VENDOR_ID 0x045e
+  #define PRODUCT_ID 0x0000
+  #define VENDOR_CODE           0xA5 // used for compat id. recommend not changing
+  #define MANUFACTURER_NAME {'T','e','e','n','s','y','d','u','i','n','o'}
+  #define MANUFACTURER_NAME_LEN 11
+  #define PRODUCT_NAME {'X', 'I', 'n', 'p', 'u', 't', '+', 'W', 'i', 'n', 'U', 'S', 'B'}
+  #define PRODUCT_NAME_LEN 13
+  #define EP0_SIZE              64
+  #define NUM_ENDPOINTS         4
+  #define NUM_USB_BUFFERS       32 // most of them for the bulk queue
+  #define NUM_INTERFACE         2
+  #define NUM_COMPAT_IDS        2 // = num interfaces
+  #define XINPUT_INTERFACE      0
+  #define XINPUT_RX_ENDPOINT    2
+  #define XINPUT_RX_SIZE        8
+  #define XINPUT_TX_ENDPOINT    1
+  #define XINPUT_TX_SIZE        20
+  #define XINPUT_BULK_INTERFACE 1 // Vendor bulk (WinUSB)
+  #define XINPUT_BULK_TX_ENDPOINT 3
+  #define XINPUT_BULK_TX_SIZE   64
+  #define XINPUT_BULK_RX_ENDPOINT 4
+  #define XINPUT_BULK_RX_SIZE   64
+  #define ENDPOINT1_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT2_CONFIG ENDPOINT_RECEIVE_ONLY
+  #define ENDPOINT3_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT4_CONFIG ENDPOINT_RECEIVE_ONLY
+// USB_XINPUT_WINUSB
+
+// XInput plus a CDC ACM serial port. The IAD groups the two CDC interfaces
+// into one function, which needs the Misc/Common/IAD device class, and the
+// compat IDs then have one function block for the IAD rather than per interface
+#elif defined(USB_XINPUT_SERIAL)
+  #define BCD_USB 0x0200 // usb version. technically not supported by teensyduino but works
+  #define OS_DESC_VERSION 0x0100
+  #define DEVICE_CLASS 0xEF // Miscellaneous
+  #define DEVICE_SUBCLASS 0x02 // Common Class
+  #define DEVICE_PROTOCOL 0x01 // Interface Association Descriptor
+  #define DEVICE_ATTRIBUTES 0xA0
+  #define VENDOR_ID 0x045e
+  #define PRODUCT_ID 0x0000
+  #define VENDOR_CODE           0xA5 // used for compat id. recommend not changing
+  #define MANUFACTURER_NAME {'T','e','e','n','s','y','d','u','i','n','o'}
+  #define MANUFACTURER_NAME_LEN 11
+  #define PRODUCT_NAME {'X', 'I', 'n', 'p', 'u', 't', '+', 'S', 'e', 'r', 'i', 'a', 'l'}
+  #define PRODUCT_NAME_LEN 13
+  #define EP0_SIZE              64
+  #define NUM_ENDPOINTS         5
+  #define NUM_USB_BUFFERS       30 // serial transmit queues up to 8
+  #define NUM_INTERFACE         3
+  #define NUM_COMPAT_IDS        2 // XInput + the CDC IAD
+  #define XINPUT_INTERFACE      0
+  #define XINPUT_RX_ENDPOINT    2
+  #define XINPUT_RX_SIZE        8
+  #define XINPUT_TX_ENDPOINT    1
+  #define XINPUT_TX_SIZE        20
+  #define CDC_IAD_DESCRIPTOR    1 // Serial
+  #define CDC_STATUS_INTERFACE  1
+  #define CDC_DATA_INTERFACE    2
+  #define CDC_ACM_ENDPOINT      3
+  #define CDC_RX_ENDPOINT       4
+  #define CDC_TX_ENDPOINT       5
+  #define CDC_ACM_SIZE          16
+  #define CDC_RX_SIZE           64
+  #define CDC_TX_SIZE           64
+  #define ENDPOINT1_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT2_CONFIG ENDPOINT_RECEIVE_ONLY
+  #define ENDPOINT3_CONFIG ENDPOINT_TRANSMIT_ONLY
+  #define ENDPOINT4_CONFIG ENDPOINT_RECEIVE_ONLY
+  #define ENDPOINT5_CONFIG ENDPOINT_TRANSMIT_ONLY
+// USB_XINPUT_SERIAL
+#endif
+
+#ifdef XINPUT_INTERFACE
+  #define XINPUT_CONTROL_CAPABILITIES 0x01C1 // vendor, interface, IN
+  #ifdef VENDOR_CODE
+  #define XINPUT_CONFIG_REQANDTYPE (((((VENDOR_CODE) << 8) & 0xFF00) | 0x40)) // vendor, device, either direction
+  #endif
 #endif
 
 #ifdef OS_DESC_VERSION
@@ -1166,6 +1331,46 @@ typedef struct {
 } usb_descriptor_list_t;
 
 extern const usb_descriptor_list_t usb_descriptor_list[];
+
+// Control requests beyond the standard (chapter 9) ones are dispatched
+// through usb_control_handler_list, first match wins. An entry matches
+// when (wRequestAndType & mask) == wRequestAndType, and wIndex matches
+// (the interface, for interface requests) unless it's USB_CONTROL_ANY_INDEX.
+typedef struct {
+	uint16_t	wRequestAndType; // bmRequestType | bRequest << 8
+	uint16_t	wValue;
+	uint16_t	wIndex;
+	uint16_t	wLength;
+} usb_control_request_t;
+
+#define USB_CONTROL_STALL	0 // not supported
+#define USB_CONTROL_ACK		1 // send *data (IN), or the status stage if none
+#define USB_CONTROL_DATA_OUT	2 // take the host's data (one packet) with 'out'
+#define USB_CONTROL_ANY_INDEX	0xFFFF
+
+typedef struct {
+	uint16_t	mask;
+	uint16_t	wRequestAndType;
+	uint16_t	wIndex;
+	int (*handler)(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen);
+	int (*out)(const usb_control_request_t *req, const uint8_t *buf, uint32_t len); // nonzero acks
+} usb_control_handler_list_t;
+
+extern const usb_control_handler_list_t usb_control_handler_list[];
+
+// Vendor requests nothing else claims. Weak, so any module can define
+// them (extern "C" from C++) without editing the core.
+int usb_control_user(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen);
+int usb_control_user_out(const usb_control_request_t *req, const uint8_t *buf, uint32_t len);
+
+#ifdef XINPUT_INTERFACE
+int usb_xinput_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen); // usb_xinput.c
+int usb_xinput_config_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen);
+int usb_xinput_config_out(const usb_control_request_t *req, const uint8_t *buf, uint32_t len);
+int usb_keyboard_nkro_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen);
+int usb_keyboard_nkro_out(const usb_control_request_t *req, const uint8_t *buf, uint32_t len);
+int usb_mouse_hires_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen);
+#endif
 #endif // NUM_ENDPOINTS
 #endif // USB_DESC_LIST_DEFINE
 
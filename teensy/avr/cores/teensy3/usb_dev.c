@@ -144,6 +144,33 @@ uint8_t usb_rx_memory_needed = 0;
 
 volatile uint8_t usb_configuration = 0;
 volatile uint8_t usb_reboot_timer = 0;
+volatile uint32_t usb_sof_count = 0;
+volatile uint8_t usb_suspended = 0;
+volatile uint8_t usb_state = USB_STATE_POWERED;
+volatile uint32_t usb_state_millis[USB_STATE_COUNT]; // when each state was last entered
+static uint8_t usb_state_resume = USB_STATE_POWERED; // state to return to after suspend
+volatile uint32_t usb_tx_frame[NUM_ENDPOINTS]; // frame of each endpoint's last IN completion, 0 if none since configured
+
+// Remote wakeup is only offered by configurations that advertise it
+#if defined(DEVICE_ATTRIBUTES) && (DEVICE_ATTRIBUTES & 0x20)
+#define REMOTE_WAKEUP_SUPPORTED
+#endif
+static volatile uint8_t usb_remote_wakeup_enabled = 0;  // set by the host
+static volatile uint8_t usb_remote_wakeup_signaled = 0;  // once per suspend
+static volatile uint32_t usb_suspend_millis = 0;
+
+
+static void usb_set_state(uint8_t state)
+{
+	uint8_t previous = usb_state;
+
+	if (state == previous) return;
+	usb_state = state;
+	usb_state_millis[state] = systick_millis_count;
+#ifdef XINPUT_INTERFACE
+	if (usb_xinput_state_callback != NULL) usb_xinput_state_callback(state, previous);
+#endif
+}
 
 
 static void endpoint0_stall(void)
@@ -169,6 +196,7 @@ static void endpoint0_transmit(const void *data, uint32_t len)
 }
 
 static uint8_t reply_buffer[8];
+static const usb_control_handler_list_t *control_out = NULL; // waiting for OUT data
 
 static void usb_setup(void)
 {
@@ -179,14 +207,32 @@ static void usb_setup(void)
 	volatile uint8_t *reg;
 	uint8_t epconf;
 	const uint8_t *cfg;
+	const usb_control_handler_list_t *ctl;
 	int i;
 
+	control_out = NULL;
+	for (ctl = usb_control_handler_list; ctl->handler != NULL; ctl++) {
+		if ((setup.wRequestAndType & ctl->mask) != ctl->wRequestAndType) continue;
+		if (ctl->wIndex != USB_CONTROL_ANY_INDEX && ctl->wIndex != setup.wIndex) continue;
+		switch (ctl->handler((const usb_control_request_t *)&setup, &data, &datalen)) {
+		  case USB_CONTROL_ACK:
+			goto send;
+		  case USB_CONTROL_DATA_OUT:
+			if (setup.wLength > EP0_SIZE || ctl->out == NULL) break;
+			control_out = ctl;
+			return;
+		}
+		endpoint0_stall();
+		return;
+	}
+
 	switch (setup.wRequestAndType) {
 	  case 0x0500: // SET_ADDRESS
 		break;
 	  case 0x0900: // SET_CONFIGURATION
 		//serial_print("configure\n");
 		usb_configuration = setup.wValue;
+		usb_set_state(setup.wValue ? USB_STATE_CONFIGURED : USB_STATE_ADDRESS);
 		reg = &USB0_ENDPT1;
 		cfg = usb_endpoint_config_table;
 		// clear all BDT entries, free any allocated memory...
@@ -214,6 +260,7 @@ static void usb_setup(void)
 			}
 			tx_first[i] = NULL;
 			tx_last[i] = NULL;
+			usb_tx_frame[i] = 0;
 			usb_rx_byte_count_data[i] = 0;
 			switch (tx_state[i]) {
 			  case TX_STATE_EVEN_FREE:
@@ -276,7 +323,7 @@ static void usb_setup(void)
 		data = reply_buffer;
 		break;
 	  case 0x0080: // GET_STATUS (device)
-		reply_buffer[0] = 0;
+		reply_buffer[0] = usb_remote_wakeup_enabled ? 0x02 : 0;
 		reply_buffer[1] = 0;
 		datalen = 2;
 		data = reply_buffer;
@@ -294,6 +341,16 @@ static void usb_setup(void)
 		data = reply_buffer;
 		datalen = 2;
 		break;
+#ifdef REMOTE_WAKEUP_SUPPORTED
+	  case 0x0100: // CLEAR_FEATURE (device)
+	  case 0x0300: // SET_FEATURE (device)
+		if (setup.wValue != 1) { // DEVICE_REMOTE_WAKEUP, test mode isn't supported
+			endpoint0_stall();
+			return;
+		}
+		usb_remote_wakeup_enabled = (setup.bRequest == 3);
+		break;
+#endif
 	  case 0x0102: // CLEAR_FEATURE (endpoint)
 		i = setup.wIndex & 0x7F;
 		if (i > NUM_ENDPOINTS || setup.wValue != 0) {
@@ -379,6 +436,15 @@ static void usb_setup(void)
 #ifdef CDC_STATUS_INTERFACE
 	  case 0x2321: // CDC_SEND_BREAK
 		break;
+	  case 0x21A1: // CDC_GET_LINE_CODING
+		// Windows reads it back when opening the port of a composite device
+		if (setup.wIndex != CDC_STATUS_INTERFACE) {
+			endpoint0_stall();
+			return;
+		}
+		data = (const uint8_t *)usb_cdc_line_coding;
+		datalen = 7;
+		break;
 	  case 0x2021: // CDC_SET_LINE_CODING
 		//serial_print("set coding, waiting...\n");
 		return;
@@ -496,32 +562,6 @@ static void usb_setup(void)
 			return;
 		}
 		break;
-#endif
-#if defined(OS_DESC_VERSION) && (OS_DESC_VERSION == 0x0100)
-	  case OS_DESC_REQANDTYPE: // 0xA5C0
-	  	if (setup.wIndex == 0x0004) { // compatible id
-	  		data = (const uint8_t *)&usb_extended_compat_id_desc;
-	  		datalen = setup.wLength;
-	  		if (setup.wLength > usb_extended_compat_id_desc.dwLength) {
-	  			datalen = usb_extended_compat_id_desc.dwLength;
-	  		}
-	  		break;
-	  	}
-	  	if (setup.wIndex == 0x0005) { // extended properties
-	  		// extended properties descriptor has requesttype C0 according to spec
-	  		// but since there can be up to one per interface they may have request type C1 (recipient=interface)
-	  		// the associated interface number is the hi byte of setup.wValue ((setup.wValue >> 8) & 0xFF)
-	  		// for now do nothing
-	  		endpoint0_stall();
-	  		return;
-	  	}
-	  	endpoint0_stall();
-	  	return;
-
-	  case OS_DESC_REQANDTYPE_IF: // 0xA5C1
-	  	// should answer the same as above only for wIndex == 0x0005
-	  	endpoint0_stall();
-	  	return;
 #endif
 	  default:
 		endpoint0_stall();
@@ -638,6 +678,14 @@ static void usb_control(uint32_t stat)
 	case 0x01:  // OUT transaction received from host
 	case 0x02:
 		//serial_print("PID=OUT\n");
+		if (control_out != NULL) {
+			if (control_out->out((const usb_control_request_t *)&setup, buf, (b->desc >> 16) & 0x3FF)) {
+				endpoint0_transmit(NULL, 0);
+			} else {
+				endpoint0_stall();
+			}
+			control_out = NULL;
+		}
 		if (setup.wRequestAndType == 0x2021 /*CDC_SET_LINE_CODING*/) {
 			int i;
 			uint32_t *line_coding = NULL;
@@ -715,6 +763,7 @@ static void usb_control(uint32_t stat)
 			//serial_phex16(setup.wValue);
 			//serial_print("\n");
 			USB0_ADDR = setup.wValue;
+			usb_set_state(setup.wValue ? USB_STATE_ADDRESS : USB_STATE_DEFAULT);
 		}
 
 		break;
@@ -784,6 +833,35 @@ uint32_t usb_tx_byte_count(uint32_t endpoint)
 // Discussion about using this function and USB transmit latency
 // https://forum.pjrc.com/threads/58663?p=223513&viewfull=1#post223513
 //
+// Frees the packets queued for transmit, which the host hasn't taken
+// yet. The (up to 2) packets already handed to the hardware are kept.
+void usb_tx_discard(uint32_t endpoint)
+{
+	usb_packet_t *p, *n;
+
+	endpoint--;
+	if (endpoint >= NUM_ENDPOINTS) return;
+	__disable_irq();
+	p = tx_first[endpoint];
+	tx_first[endpoint] = NULL;
+	tx_last[endpoint] = NULL;
+	__enable_irq();
+	while (p) {
+		n = p->next;
+		usb_free(p);
+		p = n;
+	}
+}
+
+// Returns 1 while the hardware holds a packet the host hasn't taken yet
+uint32_t usb_tx_busy(uint32_t endpoint)
+{
+	endpoint--;
+	if (endpoint >= NUM_ENDPOINTS) return 0;
+	return tx_state[endpoint] != TX_STATE_BOTH_FREE_EVEN_FIRST &&
+		tx_state[endpoint] != TX_STATE_BOTH_FREE_ODD_FIRST;
+}
+
 uint32_t usb_tx_packet_count(uint32_t endpoint)
 {
 	const usb_packet_t *p;
@@ -917,10 +995,127 @@ void usb_tx_isochronous(uint32_t endpoint, void *data, uint32_t len)
 
 
 
+// Bus signaling that has to be held for milliseconds (remote wakeup, soft
+// reconnect) is timed from the systick, with this handler chained in front of the
+// core's while there's something to time. Nothing blocks, even though
+// it's started from the USB interrupt.
+#define USB_SYSTICK_VECTOR 15
+static void (*usb_systick_next)(void) = NULL;
+static volatile uint8_t usb_wakeup_stage = 0;  // 0 idle, 1 waiting for an idle bus, 2 signaling resume
+static uint32_t usb_wakeup_begin = 0;
+static volatile uint32_t usb_reconnect_ms = 0;  // pullup off for this long, 0 if connected
+static uint32_t usb_reconnect_begin = 0;
+
+static void usb_systick_timer(void);
+
+static void usb_systick_attach(void)
+{
+	if (_VectorsRam[USB_SYSTICK_VECTOR] == usb_systick_timer) return;
+	usb_systick_next = _VectorsRam[USB_SYSTICK_VECTOR];
+	_VectorsRam[USB_SYSTICK_VECTOR] = usb_systick_timer;
+}
+
+static void usb_systick_detach(void)
+{
+	if (usb_wakeup_stage || usb_reconnect_ms) return;  // still timing
+	if (_VectorsRam[USB_SYSTICK_VECTOR] == usb_systick_timer) {
+		_VectorsRam[USB_SYSTICK_VECTOR] = usb_systick_next;
+	}
+}
+
+static void usb_wakeup_end(void)
+{
+	if (usb_wakeup_stage == 2) USB0_CTL &= ~USB_CTL_RESUME;
+	usb_wakeup_stage = 0;
+	usb_systick_detach();
+}
+
+static void usb_wakeup_step(void)
+{
+	if (usb_wakeup_stage == 1) {
+		// the bus must be idle for 5 ms first, suspend was detected after 3
+		if (systick_millis_count - usb_suspend_millis < 3) return;
+		USB0_USBCTRL &= ~USB_USBCTRL_SUSP;
+		USB0_CTL |= USB_CTL_RESUME;
+		usb_wakeup_begin = systick_millis_count;
+		usb_wakeup_stage = 2;
+	} else if (usb_wakeup_stage == 2) {
+		// resume signaling must last 1 to 15 ms, then the host takes over
+		if (systick_millis_count - usb_wakeup_begin < 5) return;
+		usb_wakeup_end();
+	}
+}
+
+static void usb_reconnect_step(void)
+{
+	if (!usb_reconnect_ms) return;
+	if (systick_millis_count - usb_reconnect_begin < usb_reconnect_ms) return;
+	usb_reconnect_ms = 0;
+	USB0_CONTROL = USB_CONTROL_DPPULLUPNONOTG;
+	usb_systick_detach();
+}
+
+static void usb_systick_timer(void)
+{
+	usb_systick_next();  // millis() first
+	usb_wakeup_step();
+	usb_reconnect_step();
+}
+
+// Leaves suspend, when the host resumes or resets the bus
+static void usb_resume(void)
+{
+	if (!usb_suspended) return;
+	if (usb_wakeup_stage) usb_wakeup_end(); // the host has the bus again
+	USB0_USBCTRL &= ~USB_USBCTRL_SUSP;
+	USB0_USBTRC0 &= ~USB_USBTRC_USBRESMEN;
+	USB0_INTEN &= ~USB_INTEN_RESUMEEN;
+	usb_suspended = 0;
+	usb_set_state(usb_state_resume);
+#ifdef XINPUT_INTERFACE
+	if (usb_xinput_suspend_callback != NULL) usb_xinput_suspend_callback(0);
+#endif
+}
+
+// Asks a suspended host to wake up, by driving resume (K state) on the
+// bus. Only if the host enabled remote wakeup, and once per suspend.
+// Returns at once, the systick starts and ends the signaling. Returns 1
+// if resume will be signaled.
+int usb_remote_wakeup(void)
+{
+	if (!usb_suspended || !usb_remote_wakeup_enabled) return 0;
+	if (usb_remote_wakeup_signaled) return 0;
+	usb_remote_wakeup_signaled = 1;
+
+	usb_wakeup_stage = 1;
+	usb_systick_attach();
+	return 1;
+}
+
+
+// Drops the D+ pullup so the host sees a disconnect, then connects again
+// for a fresh enumeration. Returns at once, safe from the USB interrupt:
+// the systick turns the pullup back on after 'ms'.
+void usb_soft_reconnect(uint32_t ms)
+{
+	USB0_CONTROL = 0;
+	usb_configuration = 0;
+	usb_state_resume = USB_STATE_POWERED;
+	usb_resume();
+	usb_set_state(USB_STATE_POWERED);
+	if (ms == 0) ms = 1;
+	usb_reconnect_begin = systick_millis_count;
+	usb_reconnect_ms = ms;
+	usb_systick_attach();
+}
+
+
 void _reboot_Teensyduino_(void)
 {
 	// TODO: initialize R0 with a code....
+#ifdef __arm__ // the host tests (extras/tests) build this file too
 	__asm__ volatile("bkpt");
+#endif
 	__builtin_unreachable();
 }
 
@@ -938,6 +1133,8 @@ void usb_isr(void)
 	status = USB0_ISTAT;
 
 	if ((status & USB_ISTAT_SOFTOK /* 04 */ )) {
+		usb_sof_count++; // 1 ms frames, unlike USB0_FRMNUM this doesn't wrap at 2048
+		if (usb_suspended) usb_resume(); // frames mean the bus is awake
 		if (usb_configuration) {
 			t = usb_reboot_timer;
 			if (t) {
@@ -980,6 +1177,16 @@ void usb_isr(void)
 #endif
 #ifdef MULTITOUCH_INTERFACE
 			usb_touchscreen_update_callback();
+#endif
+#ifdef XINPUT_INTERFACE
+			usb_xinput_watchdog();
+#ifdef KEYBOARD_NKRO_INTERFACE
+			usb_keyboard_nkro_send(); // a change the queue couldn't take earlier
+#endif
+#ifdef MOUSE_HIRES_INTERFACE
+			usb_mouse_hires_frame(); // stick motion and carried sub-counts
+#endif
+			if (usb_xinput_sof_callback != NULL) usb_xinput_sof_callback();
 #endif
 		}
 		USB0_ISTAT = USB_ISTAT_SOFTOK;
@@ -1032,6 +1239,7 @@ void usb_isr(void)
 			} else
 #endif
 			if (stat & 0x08) { // transmit
+				usb_tx_frame[endpoint] = usb_sof_count;
 				usb_free(packet);
 				packet = tx_first[endpoint];
 				if (packet) {
@@ -1118,7 +1326,17 @@ void usb_isr(void)
 			
 #ifdef XINPUT_INTERFACE
 			// On receipt of control packet, call XInput receive callback
-			if((endpoint == XINPUT_RX_ENDPOINT - 1) && !(stat & 0x08)) {
+			if(!(stat & 0x08) && (endpoint == XINPUT_RX_ENDPOINT - 1
+#ifdef XINPUT2_INTERFACE
+			  || endpoint == XINPUT2_RX_ENDPOINT - 1
+#endif
+#ifdef XINPUT3_INTERFACE
+			  || endpoint == XINPUT3_RX_ENDPOINT - 1
+#endif
+#ifdef XINPUT4_INTERFACE
+			  || endpoint == XINPUT4_RX_ENDPOINT - 1
+#endif
+			  )) {
 				if(usb_xinput_recv_callback != NULL) { usb_xinput_recv_callback(); }
 			}
 #endif
@@ -1133,6 +1351,12 @@ void usb_isr(void)
 	if (status & USB_ISTAT_USBRST /* 01 */ ) {
 		//serial_print("reset\n");
 
+		// reset ends suspend, and clears the remote wakeup feature
+		usb_state_resume = USB_STATE_DEFAULT;
+		usb_resume();
+		usb_remote_wakeup_enabled = 0;
+		usb_set_state(USB_STATE_DEFAULT);
+
 		// initialize BDT toggle bits
 		USB0_CTL = USB_CTL_ODDRST;
 		ep0_tx_bdt_bank = 0;
@@ -1186,9 +1410,31 @@ void usb_isr(void)
 
 	if ((status & USB_ISTAT_SLEEP /* 10 */ )) {
 		//serial_print("sleep\n");
+		// bus idle for 3 ms: suspend the transceiver, and wake on resume
+		// signaling (asynchronously, in case the clocks are stopped)
+		if (!usb_suspended) {
+			usb_suspended = 1;
+			usb_remote_wakeup_signaled = 0;
+			usb_suspend_millis = systick_millis_count;
+			usb_state_resume = usb_state;
+			usb_set_state(USB_STATE_SUSPENDED);
+			USB0_ISTAT = USB_ISTAT_RESUME;
+			USB0_INTEN |= USB_INTEN_RESUMEEN;
+			USB0_USBTRC0 |= USB_USBTRC_USBRESMEN;
+			USB0_USBCTRL |= USB_USBCTRL_SUSP;
+#ifdef XINPUT_INTERFACE
+			if (usb_xinput_suspend_callback != NULL) usb_xinput_suspend_callback(1);
+#endif
+		}
 		USB0_ISTAT = USB_ISTAT_SLEEP;
 	}
 
+	if ((status & USB_ISTAT_RESUME /* 20 */ ) || (USB0_USBTRC0 & USB_USBTRC_USB_RESUME_INT)) {
+		//serial_print("resume\n");
+		usb_resume();
+		USB0_ISTAT = USB_ISTAT_RESUME;
+	}
+
 }
 
 
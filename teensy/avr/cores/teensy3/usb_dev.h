@@ -55,8 +55,25 @@ uint32_t usb_tx_byte_count(uint32_t endpoint);
 uint32_t usb_tx_packet_count(uint32_t endpoint);
 void usb_tx(uint32_t endpoint, usb_packet_t *packet);
 void usb_tx_isochronous(uint32_t endpoint, void *data, uint32_t len);
+void usb_tx_discard(uint32_t endpoint);
+uint32_t usb_tx_busy(uint32_t endpoint);
+void usb_soft_reconnect(uint32_t ms);
+extern volatile uint32_t usb_tx_frame[NUM_ENDPOINTS];
 
 extern volatile uint8_t usb_configuration;
+extern volatile uint32_t usb_sof_count;
+extern volatile uint8_t usb_suspended;
+
+// Device states (USB 2.0, 9.1.1). Suspended returns to the previous state.
+#define USB_STATE_POWERED	0 // attached, not reset yet
+#define USB_STATE_DEFAULT	1 // reset, address 0
+#define USB_STATE_ADDRESS	2
+#define USB_STATE_CONFIGURED	3
+#define USB_STATE_SUSPENDED	4
+#define USB_STATE_COUNT		5
+extern volatile uint8_t usb_state;
+extern volatile uint32_t usb_state_millis[USB_STATE_COUNT];
+int usb_remote_wakeup(void);
 
 extern uint16_t usb_rx_byte_count_data[NUM_ENDPOINTS];
 static inline uint32_t usb_rx_byte_count(uint32_t endpoint) __attribute__((always_inline));
@@ -107,6 +124,16 @@ extern void usb_touchscreen_update_callback(void);
 
 #ifdef XINPUT_INTERFACE
 extern void (*usb_xinput_recv_callback)(void);
+extern void (*usb_xinput_sof_callback)(void);
+extern void (*usb_xinput_suspend_callback)(uint8_t suspended);
+extern void (*usb_xinput_state_callback)(uint8_t state, uint8_t previous);
+extern void usb_xinput_watchdog(void);
+#ifdef KEYBOARD_NKRO_INTERFACE
+extern int usb_keyboard_nkro_send(void);
+#endif
+#ifdef MOUSE_HIRES_INTERFACE
+extern void usb_mouse_hires_frame(void);
+#endif
 #endif
 
 
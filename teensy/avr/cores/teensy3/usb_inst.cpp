@@ -99,7 +99,8 @@ usb_serial_class Serial;
 //
 // This could probably be handled in a more versatile way by modifying
 // XInput.cpp
-#if defined(USB_XINPUT) | defined(USB_XINPUT_KEYBOARD_MOUSE) 
+#if defined(USB_XINPUT) | defined(USB_XINPUT_KEYBOARD_MOUSE) | defined(USB_XINPUT_X2) | defined(USB_XINPUT_X4) \
+  | defined(USB_XINPUT_WINUSB)
 usb_serial_class Serial;
 #endif
 
@@ -107,6 +108,14 @@ usb_serial_class Serial;
 usb_seremu_class Serial;
 #endif
 
+#ifdef KEYBOARD_NKRO_INTERFACE
+usb_keyboard_nkro_class Keyboard;
+#endif
+
+#ifdef MOUSE_HIRES_INTERFACE
+usb_mouse_hires_class Mouse;
+#endif
+
 // TODO: other usb types for XInput
 
 
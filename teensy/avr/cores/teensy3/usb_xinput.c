@@ -34,6 +34,37 @@
 static const uint32_t timeout = 250;  // ms
 
 void (*usb_xinput_recv_callback)(void) = NULL;
+void (*usb_xinput_sof_callback)(void) = NULL;
+void (*usb_xinput_suspend_callback)(uint8_t suspended) = NULL;
+void (*usb_xinput_state_callback)(uint8_t state, uint8_t previous) = NULL;
+int (*usb_xinput_config_callback)(bool in, uint16_t command, uint16_t value, uint8_t *buf, uint8_t len) = NULL;
+
+// Endpoints for each XInput interface, by index
+static const uint8_t tx_endpoint[XINPUT_COUNT] = {
+	XINPUT_TX_ENDPOINT,
+#ifdef XINPUT2_INTERFACE
+	XINPUT2_TX_ENDPOINT,
+#endif
+#ifdef XINPUT3_INTERFACE
+	XINPUT3_TX_ENDPOINT,
+#endif
+#ifdef XINPUT4_INTERFACE
+	XINPUT4_TX_ENDPOINT,
+#endif
+};
+
+static const uint8_t rx_endpoint[XINPUT_COUNT] = {
+	XINPUT_RX_ENDPOINT,
+#ifdef XINPUT2_INTERFACE
+	XINPUT2_RX_ENDPOINT,
+#endif
+#ifdef XINPUT3_INTERFACE
+	XINPUT3_RX_ENDPOINT,
+#endif
+#ifdef XINPUT4_INTERFACE
+	XINPUT4_RX_ENDPOINT,
+#endif
+};
 
 // Function returns whether the microcontroller's USB
 // is configured or not (connected to driver)
@@ -45,24 +76,35 @@ bool usb_xinput_connected(void)
 // Function to check if packets are available
 // to be received on the RX endpoint
 uint16_t usb_xinput_available(void)
+{
+	return usb_xinput_available_n(0);
+}
+
+uint16_t usb_xinput_available_n(uint8_t index)
 {
 	uint16_t count;
 
-	if (!usb_configuration) return 0;
-	count = usb_rx_byte_count(XINPUT_RX_ENDPOINT);
+	if (!usb_configuration || index >= XINPUT_COUNT) return 0;
+	count = usb_rx_byte_count(rx_endpoint[index]);
 	return count;
 }
 
 
 // Function receives packets from the RX endpoint
 int usb_xinput_recv(void *buffer, uint8_t nbytes)
+{
+	return usb_xinput_recv_n(0, buffer, nbytes);
+}
+
+int usb_xinput_recv_n(uint8_t index, void *buffer, uint8_t nbytes)
 {
 	usb_packet_t *rx_packet;
 	uint32_t begin = millis();
 
+	if (index >= XINPUT_COUNT) return -1;
 	while (1) {
 		if (!usb_configuration) return -1;
-		rx_packet = usb_rx(XINPUT_RX_ENDPOINT);
+		rx_packet = usb_rx(rx_endpoint[index]);
 		if (rx_packet) break;
 		if (millis() - begin > timeout || !timeout) return 0;
 		yield();
@@ -72,19 +114,91 @@ int usb_xinput_recv(void *buffer, uint8_t nbytes)
 	return nbytes;
 }
 
+// Function returns the number of USB frames (SOF tokens)
+// seen since power-up, one per millisecond
+uint32_t usb_xinput_frame_count(void)
+{
+	return usb_sof_count;
+}
+
+// Function returns true while the host has the bus suspended (asleep)
+bool usb_xinput_suspended(void)
+{
+	return usb_suspended;
+}
+
+// Wakeup timing: from the request to the first report the host takes
+static volatile uint8_t wakeup_pending = 0;
+static uint32_t wakeup_frame = 0;
+static uint32_t wakeup_millis = 0;
+static volatile uint32_t wakeup_ms = 0;
+
+// Function asks a suspended host to wake up. Returns at once, the resume
+// signaling is timed in the background. Returns false if the host is
+// awake or hasn't enabled remote wakeup.
+bool usb_xinput_wakeup(void)
+{
+	if (!usb_remote_wakeup()) return false;
+	wakeup_frame = usb_sof_count;
+	wakeup_millis = millis();
+	wakeup_pending = 1;
+	return true;
+}
+
+// Function returns the ms from the last wakeup request to the first
+// report the host took after it, 0 if there's been none
+uint32_t usb_xinput_wakeup_time(void)
+{
+	return wakeup_ms;
+}
+
+// From the SOF interrupt, once the host is back after a wakeup
+static void usb_xinput_wakeup_check(void)
+{
+	uint8_t i;
+
+	if (!wakeup_pending) return;
+	for (i=0; i < XINPUT_COUNT; i++) {
+		if (usb_tx_frame[tx_endpoint[i] - 1] > wakeup_frame) {
+			wakeup_ms = millis() - wakeup_millis;
+			wakeup_pending = 0;
+			return;
+		}
+	}
+}
+
+// Function returns the device state, one of USB_STATE_* (usb_dev.h)
+uint8_t usb_xinput_state(void)
+{
+	return usb_state;
+}
+
+// Function returns when a state was last entered (millis), 0 if never
+uint32_t usb_xinput_state_millis(uint8_t state)
+{
+	if (state >= USB_STATE_COUNT) return 0;
+	return usb_state_millis[state];
+}
+
 // Maximum number of transmit packets to queue so we don't starve other endpoints for memory
 #define TX_PACKET_LIMIT 3
 
 // Function used to send packets out of the TX endpoint
 // This is used to send button reports
 int usb_xinput_send(const void *buffer, uint8_t nbytes)
+{
+	return usb_xinput_send_n(0, buffer, nbytes);
+}
+
+int usb_xinput_send_n(uint8_t index, const void *buffer, uint8_t nbytes)
 {
 	usb_packet_t *tx_packet;
 	uint32_t begin = millis();
 
+	if (index >= XINPUT_COUNT) return -1;
 	while (1) {
-		if (!usb_configuration) return -1;
-		if (usb_tx_packet_count(XINPUT_TX_ENDPOINT) < TX_PACKET_LIMIT) {
+		if (usb_state != USB_STATE_CONFIGURED) return -1;  // Host gone or asleep, don't wait
+		if (usb_tx_packet_count(tx_endpoint[index]) < TX_PACKET_LIMIT) {
 			tx_packet = usb_malloc();
 			if (tx_packet) break;
 		}
@@ -93,9 +207,508 @@ int usb_xinput_send(const void *buffer, uint8_t nbytes)
 	}
 	memcpy(tx_packet->buf, buffer, nbytes);
 	tx_packet->len = nbytes;
-	usb_tx(XINPUT_TX_ENDPOINT, tx_packet);
+	usb_tx(tx_endpoint[index], tx_packet);
+	return nbytes;
+}
+
+// Non-blocking send, safe to call from interrupts (e.g. the SOF callback).
+// Returns 0 if the packet can't be queued right now.
+int usb_xinput_try_send_n(uint8_t index, const void *buffer, uint8_t nbytes)
+{
+	usb_packet_t *tx_packet;
+
+	if (usb_state != USB_STATE_CONFIGURED || index >= XINPUT_COUNT) return -1;
+	if (usb_tx_packet_count(tx_endpoint[index]) >= TX_PACKET_LIMIT) return 0;
+	tx_packet = usb_malloc();
+	if (!tx_packet) return 0;
+	memcpy(tx_packet->buf, buffer, nbytes);
+	tx_packet->len = nbytes;
+	usb_tx(tx_endpoint[index], tx_packet);
+	return nbytes;
+}
+
+#ifdef JOYSTICK_INTERFACE
+// Mirrored send, for XInput + DirectInput. The XInput report and its joystick
+// copy are queued as a pair: both packets are allocated before either is
+// handed over, so the host never gets one without the other. With 'wait'
+// this blocks up to the timeout for room, otherwise it returns 0 at once.
+static int mirror_queue(uint8_t index, const void *buffer, uint8_t nbytes, const void *joystick, bool wait)
+{
+	usb_packet_t *tx_packet, *joy_packet;
+	uint32_t begin = millis();
+
+	if (index >= XINPUT_COUNT) return -1;
+	while (1) {
+		if (usb_state != USB_STATE_CONFIGURED) return -1;  // Host gone or asleep, don't wait
+		if (usb_tx_packet_count(tx_endpoint[index]) < TX_PACKET_LIMIT
+			&& usb_tx_packet_count(JOYSTICK_ENDPOINT) < TX_PACKET_LIMIT) {
+			tx_packet = usb_malloc();
+			if (tx_packet) {
+				joy_packet = usb_malloc();
+				if (joy_packet) break;
+				usb_free(tx_packet);
+			}
+		}
+		if (!wait || millis() - begin > timeout) return 0;
+		yield();
+	}
+	memcpy(tx_packet->buf, buffer, nbytes);
+	tx_packet->len = nbytes;
+	memcpy(joy_packet->buf, joystick, JOYSTICK_SIZE);
+	joy_packet->len = JOYSTICK_SIZE;
+	usb_tx(tx_endpoint[index], tx_packet);
+	usb_tx(JOYSTICK_ENDPOINT, joy_packet);
+	return nbytes;
+}
+
+int usb_xinput_mirror_send_n(uint8_t index, const void *buffer, uint8_t nbytes, const void *joystick)
+{
+	return mirror_queue(index, buffer, nbytes, joystick, true);
+}
+
+// Non-blocking, safe to call from interrupts
+int usb_xinput_mirror_try_send_n(uint8_t index, const void *buffer, uint8_t nbytes, const void *joystick)
+{
+	return mirror_queue(index, buffer, nbytes, joystick, false);
+}
+#endif // JOYSTICK_INTERFACE
+
+// Stall watchdog. While configured, a report the host doesn't take (no IN
+// poll) for 'flush' frames empties the queue. If it's still stuck after
+// 'reconnect' more, the device disconnects and enumerates again.
+// Endpoints that were never polled (e.g. no driver) are left alone.
+#define WATCHDOG_DISCONNECT_MS 20  // D+ pullup off, the host sees it after 2.5 us
+
+static uint16_t watchdog_flush = 0;  // frames, 0 disables
+static uint16_t watchdog_reconnect = 0;
+static uint8_t watchdog_stage = 0;  // 0 watching, 1 flushed, 2 reconnected
+static uint32_t watchdog_stall_millis = 0;
+static uint32_t watchdog_seen[XINPUT_COUNT];  // last IN completion seen
+static uint32_t watchdog_wait[XINPUT_COUNT];  // frame the host was first left waiting, 0 if idle
+static volatile uint32_t watchdog_recovery_ms = 0;
+
+void usb_xinput_watchdog_set(uint16_t flush_ms, uint16_t reconnect_ms)
+{
+	__disable_irq();
+	watchdog_flush = flush_ms;
+	watchdog_reconnect = reconnect_ms;
+	watchdog_stage = 0;
+	memset(watchdog_wait, 0, sizeof(watchdog_wait));
+	__enable_irq();
+}
+
+uint32_t usb_xinput_recovery_time(void)
+{
+	return watchdog_recovery_ms;
+}
+
+// Called from the SOF interrupt while configured
+void usb_xinput_watchdog(void)
+{
+	uint32_t now = usb_sof_count;
+	uint32_t last, waited;
+	uint8_t i, ep;
+
+	usb_xinput_wakeup_check();
+	if (!watchdog_flush) return;
+	for (i=0; i < XINPUT_COUNT; i++) {
+		ep = tx_endpoint[i];
+		last = usb_tx_frame[ep - 1];
+		if (last != watchdog_seen[i]) { // host took a report
+			watchdog_seen[i] = last;
+			watchdog_wait[i] = 0;
+			if (watchdog_stage && last) {
+				watchdog_recovery_ms = millis() - watchdog_stall_millis;
+				watchdog_stage = 0;
+			}
+		}
+		if (!usb_tx_busy(ep)) {
+			watchdog_wait[i] = 0;
+			continue;
+		}
+		if (!watchdog_wait[i]) {
+			watchdog_wait[i] = now;
+			continue;
+		}
+		if (!last) continue; // never polled since configured
+		waited = now - watchdog_wait[i];
+		if (watchdog_stage == 0 && waited >= watchdog_flush) {
+			watchdog_stage = 1;
+			watchdog_stall_millis = millis();
+			for (ep=0; ep < XINPUT_COUNT; ep++) usb_tx_discard(tx_endpoint[ep]);
+		} else if (watchdog_stage == 1 && watchdog_reconnect &&
+		  waited >= (uint32_t)watchdog_flush + watchdog_reconnect) {
+			watchdog_stage = 2; // once, until the host takes a report again
+			memset(watchdog_wait, 0, sizeof(watchdog_wait));
+			usb_soft_reconnect(WATCHDOG_DISCONNECT_MS);
+			return;
+		}
+	}
+}
+
+// XUSB capabilities request (vendor, interface), answered like a wired
+// controller: a report with every bit the device drives set (wValue 0x0100),
+// or the rumble values it takes (wValue 0x0000). Registered in usb_desc.c.
+static const uint8_t xinput_input_caps[20] = {
+	0x00, 0x14, 0xFF, 0xF7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,  // buttons (no bit 11), triggers, sticks
+	0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+static const uint8_t xinput_output_caps[8] = {
+	0x00, 0x08, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00  // large, small motor
+};
+
+int usb_xinput_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen)
+{
+	if (req->wValue == 0x0100) {
+		*data = xinput_input_caps;
+		*datalen = sizeof(xinput_input_caps);
+	} else if (req->wValue == 0x0000) {
+		*data = xinput_output_caps;
+		*datalen = sizeof(xinput_output_caps);
+	} else {
+		return USB_CONTROL_STALL;
+	}
+	return USB_CONTROL_ACK;
+}
+
+// Vendor configuration channel, registered in usb_desc.c. Runs on EP0 in
+// the USB interrupt, so the XInput endpoints' transfers are unaffected.
+static uint8_t config_buffer[64];
+
+int usb_xinput_config_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen)
+{
+	uint8_t len = req->wLength > sizeof(config_buffer) ? sizeof(config_buffer) : req->wLength;
+	int n;
+
+	if (usb_xinput_config_callback == NULL || req->wIndex < 0x0100) return USB_CONTROL_STALL;
+	if (req->wRequestAndType & 0x80) { // device to host
+		n = usb_xinput_config_callback(true, req->wIndex, req->wValue, config_buffer, len);
+		if (n < 0) return USB_CONTROL_STALL;
+		*data = config_buffer;
+		*datalen = n;
+		return USB_CONTROL_ACK;
+	}
+	if (req->wLength == 0) {
+		n = usb_xinput_config_callback(false, req->wIndex, req->wValue, config_buffer, 0);
+		return n < 0 ? USB_CONTROL_STALL : USB_CONTROL_ACK;
+	}
+	return USB_CONTROL_DATA_OUT;
+}
+
+int usb_xinput_config_out(const usb_control_request_t *req, const uint8_t *buf, uint32_t len)
+{
+	if (usb_xinput_config_callback == NULL || len > sizeof(config_buffer)) return 0;
+	memcpy(config_buffer, buf, len);
+	return usb_xinput_config_callback(false, req->wIndex, req->wValue, config_buffer, len) >= 0;
+}
+
+// Function drops the reports queued for the host, e.g. once it's gone
+void usb_xinput_discard_n(uint8_t index)
+{
+	if (index >= XINPUT_COUNT) return;
+	usb_tx_discard(tx_endpoint[index]);
+}
+
+#ifdef XINPUT_BULK_INTERFACE
+// Bulk side channel. The queue is deeper than the XInput one so the host
+// can take several packets per frame, but leaves buffers for the rest.
+#define BULK_TX_PACKET_LIMIT 16
+
+// Function returns how many more packets can be queued right now
+uint8_t usb_xinput_bulk_tx_free(void)
+{
+	uint32_t queued;
+
+	if (usb_state != USB_STATE_CONFIGURED) return 0;
+	queued = usb_tx_packet_count(XINPUT_BULK_TX_ENDPOINT);
+	return queued < BULK_TX_PACKET_LIMIT ? BULK_TX_PACKET_LIMIT - queued : 0;
+}
+
+// Non-blocking, queues one packet of up to XINPUT_BULK_TX_SIZE bytes.
+// Returns 0 if the queue is full, -1 if the host isn't there.
+int usb_xinput_bulk_send(const void *buffer, uint8_t nbytes)
+{
+	usb_packet_t *tx_packet;
+
+	if (usb_state != USB_STATE_CONFIGURED) return -1;
+	if (nbytes > XINPUT_BULK_TX_SIZE) nbytes = XINPUT_BULK_TX_SIZE;
+	if (usb_tx_packet_count(XINPUT_BULK_TX_ENDPOINT) >= BULK_TX_PACKET_LIMIT) return 0;
+	tx_packet = usb_malloc();
+	if (!tx_packet) return 0;
+	memcpy(tx_packet->buf, buffer, nbytes);
+	tx_packet->len = nbytes;
+	usb_tx(XINPUT_BULK_TX_ENDPOINT, tx_packet);
+	return nbytes;
+}
+
+// Function returns the number of bytes waiting from the host
+uint16_t usb_xinput_bulk_available(void)
+{
+	if (!usb_configuration) return 0;
+	return usb_rx_byte_count(XINPUT_BULK_RX_ENDPOINT);
+}
+
+// Non-blocking, copies out one packet. Returns its length (at most
+// 'nbytes', the rest is dropped) or 0 if nothing arrived.
+int usb_xinput_bulk_recv(void *buffer, uint8_t nbytes)
+{
+	usb_packet_t *rx_packet;
+
+	if (!usb_configuration) return -1;
+	rx_packet = usb_rx(XINPUT_BULK_RX_ENDPOINT);
+	if (!rx_packet) return 0;
+	if (nbytes > rx_packet->len) nbytes = rx_packet->len;
+	memcpy(buffer, rx_packet->buf, nbytes);
+	usb_free(rx_packet);
 	return nbytes;
 }
+#endif // XINPUT_BULK_INTERFACE
+
+#ifdef KEYBOARD_NKRO_INTERFACE
+// N-key rollover keyboard. Byte 0 holds the modifiers, the rest is one bit
+// per key code (HID usage) 0-119. The report is compared a word at a time
+// against the last one sent, and only goes out when it differs.
+#define NKRO_WORDS (KEYBOARD_NKRO_SIZE / 4)
+
+typedef union {
+	uint32_t words[NKRO_WORDS];
+	uint8_t bytes[KEYBOARD_NKRO_SIZE];
+} nkro_report_t;
+
+static nkro_report_t nkro_report;  // current state, changed from the sketch
+static nkro_report_t nkro_sent;    // last report queued for the host
+static volatile uint8_t nkro_leds = 0;
+
+static bool nkro_changed(void)
+{
+	uint32_t diff = 0;
+	uint8_t i;
+
+	for (i = 0; i < NKRO_WORDS; i++) diff |= nkro_report.words[i] ^ nkro_sent.words[i];
+	return diff != 0;
+}
+
+// Function sets or clears a key. 'key' is a KEY_* or MODIFIERKEY_* code
+// (keylayouts.h) or a plain usage. Media and system keys aren't in this
+// report and are ignored. Nothing is sent until usb_keyboard_nkro_send().
+void usb_keyboard_nkro_set(uint16_t key, bool pressed)
+{
+	uint8_t *byte;
+	uint8_t mask;
+
+	if ((key & 0xFF00) == 0xE000) {  // MODIFIERKEY_*, already a bit mask
+		byte = &nkro_report.bytes[0];
+		mask = key & 0xFF;
+	} else {
+		if ((key & 0xFF00) == 0xF000) key &= 0xFF;  // KEY_*
+		if (key >= 0xE0 && key <= 0xE7) {
+			byte = &nkro_report.bytes[0];
+			mask = 1 << (key - 0xE0);
+		} else if (key < (KEYBOARD_NKRO_SIZE - 1) * 8) {
+			byte = &nkro_report.bytes[1 + (key >> 3)];
+			mask = 1 << (key & 7);
+		} else {
+			return;  // not in the bitmap
+		}
+	}
+	if (pressed) *byte |= mask;
+	else *byte &= ~mask;
+}
+
+void usb_keyboard_nkro_clear(void)
+{
+	memset(nkro_report.bytes, 0, sizeof(nkro_report.bytes));
+}
+
+// Function queues the report if it changed since the last one. Returns 1
+// if sent, 0 if unchanged or the queue is full (the SOF retries it), -1
+// if the host isn't there. Also called every frame from the USB interrupt.
+int usb_keyboard_nkro_send(void)
+{
+	usb_packet_t *tx_packet;
+	bool changed;
+
+	if (usb_state != USB_STATE_CONFIGURED) return -1;
+	if (!nkro_changed()) return 0;
+	if (usb_tx_packet_count(KEYBOARD_NKRO_ENDPOINT) >= TX_PACKET_LIMIT) return 0;
+	tx_packet = usb_malloc();
+	if (!tx_packet) return 0;
+
+	// the sketch and the SOF interrupt can both get here, only one sends
+	__disable_irq();
+	changed = nkro_changed();
+	if (changed) {
+		memcpy(tx_packet->buf, nkro_report.bytes, KEYBOARD_NKRO_SIZE);
+		nkro_sent = nkro_report;
+	}
+	__enable_irq();
+	if (!changed) {
+		usb_free(tx_packet);
+		return 0;
+	}
+	tx_packet->len = KEYBOARD_NKRO_SIZE;
+	usb_tx(KEYBOARD_NKRO_ENDPOINT, tx_packet);
+	return 1;
+}
+
+uint8_t usb_keyboard_nkro_leds(void)
+{
+	return nkro_leds;
+}
+
+// HID class requests for the keyboard interface, registered in usb_desc.c.
+// The report only goes out on change, so the idle rate is accepted and ignored.
+static const uint8_t nkro_zero = 0;
+static const uint8_t nkro_report_protocol = 1;
+
+int usb_keyboard_nkro_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen)
+{
+	switch (req->wRequestAndType) {
+	  case 0x01A1: // GET_REPORT
+		*data = nkro_sent.bytes;
+		*datalen = KEYBOARD_NKRO_SIZE;
+		return USB_CONTROL_ACK;
+	  case 0x02A1: // GET_IDLE
+		*data = &nkro_zero;
+		*datalen = 1;
+		return USB_CONTROL_ACK;
+	  case 0x03A1: // GET_PROTOCOL
+		*data = &nkro_report_protocol;
+		*datalen = 1;
+		return USB_CONTROL_ACK;
+	  case 0x0921: // SET_REPORT (LEDs)
+		return req->wLength ? USB_CONTROL_DATA_OUT : USB_CONTROL_STALL;
+	  case 0x0A21: // SET_IDLE
+	  case 0x0B21: // SET_PROTOCOL
+		return USB_CONTROL_ACK;
+	}
+	return USB_CONTROL_STALL;
+}
+
+int usb_keyboard_nkro_out(const usb_control_request_t *req, const uint8_t *buf, uint32_t len)
+{
+	(void) req;  // SET_REPORT is the only OUT request here
+	if (len < 1) return 0;
+	nkro_leds = buf[0];
+	return 1;
+}
+#endif // KEYBOARD_NKRO_INTERFACE
+
+#ifdef MOUSE_HIRES_INTERFACE
+// High resolution mouse. Motion is kept in 24.8 fixed point: each frame
+// the whole counts go out and the fraction stays for the next one, so slow
+// motion isn't rounded away. Moves bigger than a report can hold carry
+// over too, up to a few frames' worth.
+#define MOUSE_FRACTION_BITS 8
+#define MOUSE_ONE           (1 << MOUSE_FRACTION_BITS)  // multiply, don't shift: counts are signed
+#define MOUSE_DELTA_MAX     32767
+#define MOUSE_ACCUM_MAX     ((int32_t)MOUSE_DELTA_MAX * MOUSE_ONE * 4)
+#define MOUSE_WHEEL_MAX     (127 * 4)  // wheel and pan carry over the same way
+
+void (*usb_mouse_hires_frame_callback)(void) = NULL;
+
+static volatile int32_t mouse_velocity[2] = {0, 0};  // per frame, 24.8
+static int32_t mouse_accum[2] = {0, 0};               // 24.8
+static int16_t mouse_wheel[2] = {0, 0};               // wheel, pan
+static volatile uint8_t mouse_buttons = 0;
+static uint8_t mouse_buttons_sent = 0;
+
+static int32_t mouse_clamp(int32_t v, int32_t limit)
+{
+	if (v > limit) return limit;
+	if (v < -limit) return -limit;
+	return v;
+}
+
+// Function adds a relative move in whole counts, sent on the next frame
+void usb_mouse_hires_move(int16_t x, int16_t y, int8_t wheel, int8_t pan)
+{
+	__disable_irq();
+	mouse_accum[0] = mouse_clamp(mouse_accum[0] + (int32_t)x * MOUSE_ONE, MOUSE_ACCUM_MAX);
+	mouse_accum[1] = mouse_clamp(mouse_accum[1] + (int32_t)y * MOUSE_ONE, MOUSE_ACCUM_MAX);
+	mouse_wheel[0] = mouse_clamp(mouse_wheel[0] + wheel, MOUSE_WHEEL_MAX);
+	mouse_wheel[1] = mouse_clamp(mouse_wheel[1] + pan, MOUSE_WHEEL_MAX);
+	__enable_irq();
+}
+
+// Function sets a steady motion, in 1/256 counts per frame (ms)
+void usb_mouse_hires_velocity(int32_t x, int32_t y)
+{
+	mouse_velocity[0] = x;
+	mouse_velocity[1] = y;
+}
+
+void usb_mouse_hires_buttons(uint8_t buttons)
+{
+	mouse_buttons = buttons;
+}
+
+uint8_t usb_mouse_hires_get_buttons(void)
+{
+	return mouse_buttons;
+}
+
+// Called every frame from the USB interrupt. Runs the frame callback (e.g.
+// the stick converter setting the velocity), adds the velocity, and sends
+// the whole counts. Nothing is lost if the queue is full, it waits a frame.
+void usb_mouse_hires_frame(void)
+{
+	usb_packet_t *tx_packet;
+	int32_t accum[2];
+	int32_t out[2];
+	int8_t wheel[2];
+	uint8_t buttons, i;
+
+	if (usb_state != USB_STATE_CONFIGURED) return;
+	if (usb_mouse_hires_frame_callback != NULL) usb_mouse_hires_frame_callback();
+
+	buttons = mouse_buttons;
+	for (i = 0; i < 2; i++) {
+		accum[i] = mouse_clamp(mouse_accum[i] + mouse_velocity[i], MOUSE_ACCUM_MAX);
+		out[i] = mouse_clamp(accum[i] >> MOUSE_FRACTION_BITS, MOUSE_DELTA_MAX);  // floor, fraction stays
+		wheel[i] = mouse_clamp(mouse_wheel[i], 127);
+	}
+	mouse_accum[0] = accum[0];
+	mouse_accum[1] = accum[1];
+	if (!out[0] && !out[1] && !wheel[0] && !wheel[1] && buttons == mouse_buttons_sent) return;
+
+	if (usb_tx_packet_count(MOUSE_HIRES_ENDPOINT) >= TX_PACKET_LIMIT) return;
+	tx_packet = usb_malloc();
+	if (!tx_packet) return;
+	tx_packet->buf[0] = buttons;
+	tx_packet->buf[1] = out[0];
+	tx_packet->buf[2] = out[0] >> 8;
+	tx_packet->buf[3] = out[1];
+	tx_packet->buf[4] = out[1] >> 8;
+	tx_packet->buf[5] = wheel[0];
+	tx_packet->buf[6] = wheel[1];
+	tx_packet->len = MOUSE_HIRES_SIZE;
+	usb_tx(MOUSE_HIRES_ENDPOINT, tx_packet);
+
+	mouse_accum[0] -= out[0] * MOUSE_ONE;
+	mouse_accum[1] -= out[1] * MOUSE_ONE;
+	mouse_wheel[0] -= wheel[0];
+	mouse_wheel[1] -= wheel[1];
+	mouse_buttons_sent = buttons;
+}
+
+// HID class requests for the mouse interface, registered in usb_desc.c
+static const uint8_t mouse_idle_report[MOUSE_HIRES_SIZE] = {0};
+
+int usb_mouse_hires_control(const usb_control_request_t *req, const uint8_t **data, uint32_t *datalen)
+{
+	switch (req->wRequestAndType) {
+	  case 0x01A1: // GET_REPORT, no motion
+		*data = mouse_idle_report;
+		*datalen = MOUSE_HIRES_SIZE;
+		return USB_CONTROL_ACK;
+	  case 0x0A21: // SET_IDLE
+	  case 0x0B21: // SET_PROTOCOL
+		return USB_CONTROL_ACK;
+	}
+	return USB_CONTROL_STALL;
+}
+#endif // MOUSE_HIRES_INTERFACE
 
 #endif // F_CPU
-#endif // XINPUT_INTERFACE
\ No newline at end of file
+#endif // XINPUT_INTERFACE
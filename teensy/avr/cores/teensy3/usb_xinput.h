@@ -32,6 +32,18 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#ifndef XINPUT_COUNT
+#define XINPUT_COUNT 1  // Number of XInput interfaces
+#endif
+
+// Joystick report size for the DirectInput mirror. A literal, as usb_undef.h
+// removes JOYSTICK_SIZE before the library sees it.
+#if defined(JOYSTICK_INTERFACE) && JOYSTICK_SIZE == 64
+#define XINPUT_MIRROR_SIZE 64
+#elif defined(JOYSTICK_INTERFACE)
+#define XINPUT_MIRROR_SIZE 12
+#endif
+
 // C language implementation
 #ifdef __cplusplus
 extern "C" {
@@ -40,7 +52,52 @@ bool usb_xinput_connected(void);
 uint16_t usb_xinput_available(void);
 int usb_xinput_send(const void *buffer, uint8_t nbytes);
 int usb_xinput_recv(void *buffer, uint8_t nbytes);
+uint32_t usb_xinput_frame_count(void);
+uint16_t usb_xinput_available_n(uint8_t index);
+int usb_xinput_send_n(uint8_t index, const void *buffer, uint8_t nbytes);
+int usb_xinput_recv_n(uint8_t index, void *buffer, uint8_t nbytes);
+int usb_xinput_try_send_n(uint8_t index, const void *buffer, uint8_t nbytes);
+bool usb_xinput_suspended(void);
+bool usb_xinput_wakeup(void);
+uint32_t usb_xinput_wakeup_time(void);
+uint8_t usb_xinput_state(void);
+uint32_t usb_xinput_state_millis(uint8_t state);
+void usb_xinput_discard_n(uint8_t index);
+void usb_xinput_watchdog_set(uint16_t flush_ms, uint16_t reconnect_ms);
+uint32_t usb_xinput_recovery_time(void);
 extern void (*usb_xinput_recv_callback)(void);
+extern void (*usb_xinput_sof_callback)(void);  // Every USB frame while configured, from the USB interrupt
+extern void (*usb_xinput_suspend_callback)(uint8_t suspended);  // Bus suspended (1) or resumed (0), from the USB interrupt
+extern void (*usb_xinput_state_callback)(uint8_t state, uint8_t previous);  // Device state changed (USB_STATE_*), from the USB interrupt
+
+// Vendor configuration channel: bRequest VENDOR_CODE, wIndex is the command
+// (0x0100 and up), from the USB interrupt. IN requests return the number of
+// bytes written to 'buf' (up to 'len'), OUT requests get 'len' bytes in 'buf'
+// and return 0 to accept them. Negative stalls. At most 64 bytes either way.
+extern int (*usb_xinput_config_callback)(bool in, uint16_t command, uint16_t value, uint8_t *buf, uint8_t len);
+#ifdef KEYBOARD_NKRO_INTERFACE
+void usb_keyboard_nkro_set(uint16_t key, bool pressed);
+void usb_keyboard_nkro_clear(void);
+int usb_keyboard_nkro_send(void);
+uint8_t usb_keyboard_nkro_leds(void);
+#endif
+#ifdef MOUSE_HIRES_INTERFACE
+void usb_mouse_hires_move(int16_t x, int16_t y, int8_t wheel, int8_t pan);
+void usb_mouse_hires_velocity(int32_t x, int32_t y);
+void usb_mouse_hires_buttons(uint8_t buttons);
+uint8_t usb_mouse_hires_get_buttons(void);
+extern void (*usb_mouse_hires_frame_callback)(void);  // Every frame before the report, from the USB interrupt
+#endif
+#ifdef JOYSTICK_INTERFACE
+int usb_xinput_mirror_send_n(uint8_t index, const void *buffer, uint8_t nbytes, const void *joystick);
+int usb_xinput_mirror_try_send_n(uint8_t index, const void *buffer, uint8_t nbytes, const void *joystick);
+#endif
+#ifdef XINPUT_BULK_INTERFACE
+uint8_t usb_xinput_bulk_tx_free(void);
+int usb_xinput_bulk_send(const void *buffer, uint8_t nbytes);
+uint16_t usb_xinput_bulk_available(void);
+int usb_xinput_bulk_recv(void *buffer, uint8_t nbytes);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -52,11 +109,86 @@ class XInputUSB
 {
 public:
 	static bool connected(void) { return usb_xinput_connected(); }
-	static uint16_t available(void) { return usb_xinput_available(); }
-	static int send(const void *buffer, uint8_t nbytes) { return usb_xinput_send(buffer, nbytes); }
-	static int recv(void *buffer, uint8_t nbytes) { return usb_xinput_recv(buffer, nbytes); }
+	static uint16_t available(uint8_t index = 0) { return usb_xinput_available_n(index); }
+	static int send(const void *buffer, uint8_t nbytes, uint8_t index = 0) { return usb_xinput_send_n(index, buffer, nbytes); }
+	static int recv(void *buffer, uint8_t nbytes, uint8_t index = 0) { return usb_xinput_recv_n(index, buffer, nbytes); }
+	static int trySend(const void *buffer, uint8_t nbytes, uint8_t index = 0) { return usb_xinput_try_send_n(index, buffer, nbytes); }
+	static uint8_t interfaces(void) { return XINPUT_COUNT; }
+	static uint32_t frameCount(void) { return usb_xinput_frame_count(); }
 	static void setRecvCallback(void (*callback)(void)) { usb_xinput_recv_callback = callback; }
+	static void setSOFCallback(void (*callback)(void)) { usb_xinput_sof_callback = callback; }
+	static bool suspended(void) { return usb_xinput_suspended(); }
+	static bool wakeup(void) { return usb_xinput_wakeup(); }
+	static uint32_t wakeupTime(void) { return usb_xinput_wakeup_time(); }  // ms, wakeup request to first report taken
+	static void setSuspendCallback(void (*callback)(uint8_t suspended)) { usb_xinput_suspend_callback = callback; }
+	static uint8_t state(void) { return usb_xinput_state(); }
+	static uint32_t stateMillis(uint8_t state) { return usb_xinput_state_millis(state); }  // When the state was last entered
+	static void discard(uint8_t index = 0) { usb_xinput_discard_n(index); }  // Drop queued reports
+	static void setStateCallback(void (*callback)(uint8_t state, uint8_t previous)) { usb_xinput_state_callback = callback; }
+	static void setConfigCallback(int (*callback)(bool in, uint16_t command, uint16_t value, uint8_t *buf, uint8_t len)) { usb_xinput_config_callback = callback; }
+	static void setWatchdog(uint16_t flushMs, uint16_t reconnectMs) { usb_xinput_watchdog_set(flushMs, reconnectMs); }  // 0 disables
+	static uint32_t recoveryTime(void) { return usb_xinput_recovery_time(); }  // ms, last stall to first report taken
+#ifdef JOYSTICK_INTERFACE
+	// XInput report plus a JOYSTICK_SIZE joystick report, queued together or not at all
+	static int mirrorSend(const void *buffer, uint8_t nbytes, const void *joystick, uint8_t index = 0) { return usb_xinput_mirror_send_n(index, buffer, nbytes, joystick); }
+	static int mirrorTrySend(const void *buffer, uint8_t nbytes, const void *joystick, uint8_t index = 0) { return usb_xinput_mirror_try_send_n(index, buffer, nbytes, joystick); }
+#endif
+#ifdef XINPUT_BULK_INTERFACE
+	static uint8_t bulkFree(void) { return usb_xinput_bulk_tx_free(); }  // Packets that can be queued
+	static int bulkSend(const void *buffer, uint8_t nbytes) { return usb_xinput_bulk_send(buffer, nbytes); }
+	static uint16_t bulkAvailable(void) { return usb_xinput_bulk_available(); }
+	static int bulkRecv(void *buffer, uint8_t nbytes) { return usb_xinput_bulk_recv(buffer, nbytes); }
+#endif
+};
+
+#ifdef KEYBOARD_NKRO_INTERFACE
+// N-key rollover keyboard for the XInput + Keyboard + Mouse type (KEYBOARD_NKRO
+// in usb_desc.h). Takes the same KEY_* / MODIFIERKEY_* codes as the regular
+// Keyboard, but any number can be held. A report only goes out on a change,
+// so chords can be built with update() and sent together with send_now().
+class usb_keyboard_nkro_class
+{
+public:
+	void press(uint16_t key) { usb_keyboard_nkro_set(key, true); usb_keyboard_nkro_send(); }
+	void release(uint16_t key) { usb_keyboard_nkro_set(key, false); usb_keyboard_nkro_send(); }
+	void releaseAll(void) { usb_keyboard_nkro_clear(); usb_keyboard_nkro_send(); }
+	void update(uint16_t key, bool pressed) { usb_keyboard_nkro_set(key, pressed); }  // No send
+	int send_now(void) { return usb_keyboard_nkro_send(); }
+	uint8_t leds(void) { return usb_keyboard_nkro_leds(); }  // Num, Caps, Scroll Lock...
+};
+extern usb_keyboard_nkro_class Keyboard;
+#endif // KEYBOARD_NKRO_INTERFACE
+
+#ifdef MOUSE_HIRES_INTERFACE
+// High resolution mouse for the XInput + Keyboard + Mouse type (MOUSE_HIRES in
+// usb_desc.h). 16-bit deltas, sent once per USB frame. Fractions of a count
+// carry over between frames, so slow and fast motion both come through whole.
+#ifndef MOUSE_LEFT  // usb_mouse.h only has them with the regular Mouse
+#define MOUSE_LEFT	1
+#define MOUSE_MIDDLE	4
+#define MOUSE_RIGHT	2
+#define MOUSE_BACK	8
+#define MOUSE_FORWARD	16
+#define MOUSE_ALL	(MOUSE_LEFT | MOUSE_RIGHT | MOUSE_MIDDLE)
+#endif
+
+class usb_mouse_hires_class
+{
+public:
+	void move(int16_t x, int16_t y, int8_t wheel = 0, int8_t pan = 0) { usb_mouse_hires_move(x, y, wheel, pan); }
+	void scroll(int8_t wheel, int8_t pan = 0) { usb_mouse_hires_move(0, 0, wheel, pan); }
+	void velocity(int32_t x, int32_t y) { usb_mouse_hires_velocity(x, y); }  // 1/256 counts per ms
+	void click(uint8_t b = MOUSE_LEFT) { press(b); delay(2); release(b); }  // Held across a frame
+	void press(uint8_t b = MOUSE_LEFT) { usb_mouse_hires_buttons(usb_mouse_hires_get_buttons() | b); }
+	void release(uint8_t b = MOUSE_LEFT) { usb_mouse_hires_buttons(usb_mouse_hires_get_buttons() & ~b); }
+	bool isPressed(uint8_t b = MOUSE_ALL) { return (usb_mouse_hires_get_buttons() & b) != 0; }
+	void set_buttons(uint8_t left, uint8_t middle = 0, uint8_t right = 0, uint8_t back = 0, uint8_t forward = 0) {
+		usb_mouse_hires_buttons((left ? 1 : 0) | (middle ? 4 : 0) | (right ? 2 : 0) | (back ? 8 : 0) | (forward ? 16 : 0));
+	}
+	static void setFrameCallback(void (*callback)(void)) { usb_mouse_hires_frame_callback = callback; }
 };
+extern usb_mouse_hires_class Mouse;
+#endif // MOUSE_HIRES_INTERFACE
 
 #endif // __cplusplus
 